@@ -0,0 +1,97 @@
+/**
+ * @brief Allocator implementations for `allocator_t`, and helpers for structures that
+ * account their memory in a `memstat_t`.
+ *
+ * @details
+ * - `stdlib_allocator` wraps malloc/realloc/free.
+ *
+ * - The arena is a bump allocator for scratch structures that are freed all at once.
+ *   Individual frees are no-ops, except that the most recent allocation is rolled back.
+ */
+
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include "defs.h"
+
+#include <stdlib.h>
+
+/**
+ * @brief Allocator backed by malloc, realloc and free
+ */
+extern const allocator_t stdlib_allocator;
+
+struct arena;
+
+/**
+ * Type of bump arena. `arena_t` is an alias for `struct arena`
+ */
+typedef struct arena arena_t;
+
+/* default size of arena blocks */
+#define ARENA_BLOCKSIZE (64 * 1024)
+
+/**
+ * @brief Create a new arena
+ * @param blocksize: size of the blocks the arena carves allocations from. 0 selects
+ * `ARENA_BLOCKSIZE`. Larger allocations get a block of their own.
+ * @returns A pointer to the newly allocated arena, or `NULL` on failure.
+ */
+arena_t *arena_create(size_t blocksize);
+
+/**
+ * @brief Destroy an arena and everything allocated from it
+ * @param arena: pointer to arena
+ */
+void arena_destroy(arena_t *arena);
+
+/**
+ * @brief Free everything allocated from an arena at once. The most recent block is kept.
+ * @param arena: pointer to arena
+ */
+void arena_reset(arena_t *arena);
+
+/**
+ * @brief Get the memory usage of an arena
+ * @param arena: pointer to arena
+ * @param stat: set to bytes handed out since the last reset, and the peak of that
+ */
+void arena_memstat(arena_t *arena, memstat_t *stat);
+
+/**
+ * @brief Get an allocator that allocates from the given arena
+ * @param arena: pointer to arena
+ * @returns An allocator with `arena` as its context
+ */
+allocator_t arena_allocator(arena_t *arena);
+
+
+/* ---- accounting helpers for structures ---- */
+
+
+static inline void *mem_alloc(const allocator_t *a, memstat_t *stat, size_t size) {
+  void *ptr = a->alloc(a->ctx, size);
+  if (NULL != ptr) {
+    stat->inuse += size;
+    if (stat->inuse > stat->peak) stat->peak = stat->inuse;
+  }
+  return ptr;
+}
+
+static inline void *mem_realloc(const allocator_t *a, memstat_t *stat, void *ptr, size_t oldsize,
+                                size_t newsize) {
+  void *newptr = a->realloc(a->ctx, ptr, oldsize, newsize);
+  if (NULL != newptr) {
+    stat->inuse = stat->inuse - oldsize + newsize;
+    if (stat->inuse > stat->peak) stat->peak = stat->inuse;
+  }
+  return newptr;
+}
+
+static inline void mem_free(const allocator_t *a, memstat_t *stat, void *ptr, size_t size) {
+  if (NULL == ptr) return;
+  a->free(a->ctx, ptr, size);
+  stat->inuse -= size;
+}
+
+#endif /* ALLOC_H */
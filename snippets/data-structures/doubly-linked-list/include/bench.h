@@ -0,0 +1,100 @@
+/**
+ * @brief Minimal benchmark harness. Benchmarks are run by release builds (`make DEBUG=0`),
+ * tests by debug builds.
+ *
+ * @details
+ * Usage:
+ * ```
+ * bench_t b;
+ * bench_begin(&b, "list_sort 1M");
+ * ...
+ * bench_end(&b, nelems);
+ * ```
+ * Results are printed to stdout, since `pr_info` is compiled out in release builds. Where
+ * hardware counters are available (see `perf.h`), each result also shows cycles,
+ * instructions, cache misses and branch misses per element, counted on the calling thread.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "perf.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Type of benchmark region. `bench_t` is an alias for `struct bench`
+ */
+typedef struct bench {
+  const char *name;
+  double start;
+  double elapsed;
+  perf_sample_t sample;
+} bench_t;
+
+/**
+ * @brief Get a monotonic timestamp
+ * @returns Seconds since an arbitrary fixed point in time
+ */
+double bench_now(void);
+
+/**
+ * @brief Start timing a benchmark region
+ * @param b: pointer to benchmark region
+ * @param name: label printed with the result
+ */
+void bench_begin(bench_t *b, const char *name);
+
+/**
+ * @brief Stop timing a benchmark region and print the result
+ * @param b: pointer to benchmark region
+ * @param nelems: number of elements processed, used for per-element figures. May be 0.
+ * @returns Elapsed time in seconds
+ */
+double bench_end(bench_t *b, size_t nelems);
+
+/**
+ * @brief Close the counter group shared by all benchmark regions. Call once all benchmarks
+ * have run
+ */
+void bench_teardown(void);
+
+/**
+ * @brief Print a section header to group related results
+ * @param title: section title
+ */
+void bench_section(const char *title);
+
+/**
+ * @brief xorshift64* pseudo-random number generator
+ * @param state: pointer to non-zero generator state
+ * @returns The next pseudo-random number
+ */
+uint64_t bench_rand(uint64_t *state);
+
+void bench_extsort(void);
+
+void bench_skiplist(void);
+
+void bench_rculist(void);
+
+void bench_alloc(void);
+
+void bench_vec(void);
+
+void bench_deque(void);
+
+void bench_pqueue(void);
+
+void bench_bloom(void);
+
+void bench_threadpool(void);
+
+void bench_ilist(void);
+
+void bench_pvec(void);
+
+void bench_ebr(void);
+
+#endif /* BENCH_H */
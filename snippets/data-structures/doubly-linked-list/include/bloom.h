@@ -0,0 +1,111 @@
+/**
+ * @brief Blocked Bloom filter for approximate membership tests.
+ *
+ * @details
+ * Each item sets and tests `k` bits inside a single 512-bit block (one cache line), chosen by
+ * its hash, so a lookup costs one cache miss at most. The bits of a lookup are gathered into a
+ * 512-bit mask and compared against the block eight words at a time, which the compiler turns
+ * into SIMD instructions.
+ *
+ * `bloom_maycontain` never reports a miss for an added item. It reports a hit for an item that
+ * was not added with roughly the false-positive rate the filter was created with, as long as
+ * no more than `capacity` items are added. Items cannot be removed.
+ *
+ * A filter can be attached to a list with `list_setfilter`, so that `list_contains` skips the
+ * scan for definite misses.
+ */
+
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include "defs.h"
+
+#include <stdlib.h>
+
+/* bits per block, one cache line */
+#define BLOOM_BLOCKBITS 512
+
+struct bloom;
+
+/**
+ * Type of Bloom filter. `bloom_t` is an alias for `struct bloom`
+ */
+typedef struct bloom bloom_t;
+
+/**
+ * Type of Bloom filter statistics. `bloom_stats_t` is an alias for `struct bloom_stats`
+ */
+typedef struct bloom_stats {
+  size_t capacity;      /* items the filter was sized for */
+  size_t count;         /* items added */
+  size_t nblocks;       /* 512-bit blocks */
+  size_t nhashes;       /* bits set per item */
+  double fprate;        /* false-positive rate the filter was sized for */
+  double fill;          /* fraction of bits set */
+  double estfprate;     /* expected false-positive rate at the current fill */
+} bloom_stats_t;
+
+/**
+ * @brief Create a new, empty Bloom filter
+ * @param hashfn: reference to hash function. Items that compare as equal must hash equal
+ * @param capacity: number of items the filter is sized for
+ * @param fprate: target false-positive rate, between 0 and 1 exclusive (e.g. 0.01)
+ * @returns A pointer to the newly allocated filter, or `NULL` on failure.
+ */
+bloom_t *bloom_create(hash64_fn hashfn, size_t capacity, double fprate);
+
+/**
+ * @brief Create a new, empty Bloom filter that allocates its storage with the given allocator
+ * @param hashfn: reference to hash function. Items that compare as equal must hash equal
+ * @param capacity: number of items the filter is sized for
+ * @param fprate: target false-positive rate, between 0 and 1 exclusive (e.g. 0.01)
+ * @param allocator: nullable. The struct is copied. If `NULL`, malloc/free are used
+ * @returns A pointer to the newly allocated filter, or `NULL` on failure.
+ */
+bloom_t *bloom_create_with_allocator(hash64_fn hashfn, size_t capacity, double fprate,
+                                     const allocator_t *allocator);
+
+/**
+ * @brief Destroy a Bloom filter. Items are not referenced by the filter
+ * @param bf: pointer to filter
+ */
+void bloom_destroy(bloom_t *bf);
+
+/**
+ * @brief Get the memory used by a Bloom filter
+ * @param bf: pointer to filter
+ * @param stat: set to the bytes currently in use, and the peak over the lifetime of the filter
+ */
+void bloom_memstat(bloom_t *bf, memstat_t *stat);
+
+/**
+ * @brief Add an item to the given Bloom filter
+ * @param bf: pointer to filter
+ * @param item: pointer to item, passed to the hash function
+ */
+void bloom_add(bloom_t *bf, const void *item);
+
+/**
+ * @brief Test whether an item may have been added to the given Bloom filter
+ * @param bf: pointer to filter
+ * @param item: pointer to item, passed to the hash function
+ * @returns 0 if the item was definitely not added, otherwise 1
+ * @note Writes nothing, so it may be called from several threads at once, as long as no
+ * thread adds or clears.
+ */
+int bloom_maycontain(bloom_t *bf, const void *item);
+
+/**
+ * @brief Remove all items from the given Bloom filter, and reset its statistics
+ * @param bf: pointer to filter
+ */
+void bloom_clear(bloom_t *bf);
+
+/**
+ * @brief Get statistics of the given Bloom filter
+ * @param bf: pointer to filter
+ * @param stats: set to the current statistics
+ */
+void bloom_stats(bloom_t *bf, bloom_stats_t *stats);
+
+#endif /* BLOOM_H */
@@ -7,6 +7,7 @@
 #define DEFS_H
 
 #include <sys/cdefs.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifndef __fallthrough
@@ -40,6 +41,28 @@ typedef void (*free_fn)(void *);
  */
 typedef uint64_t (*hash64_fn)(const void *);
 
+/**
+ * @brief Allocator interface. Structures created `_with_allocator` route all of their
+ * own memory (not that of their items) through it.
+ *
+ * @note The size of a block is passed back to `realloc` and `free`, so allocators
+ * need not store it in a header.
+ */
+typedef struct allocator {
+  void *(*alloc)(void *ctx, size_t size);
+  void *(*realloc)(void *ctx, void *ptr, size_t oldsize, size_t newsize);
+  void (*free)(void *ctx, void *ptr, size_t size);
+  void *ctx;
+} allocator_t;
+
+/**
+ * @brief Memory accounting of a single structure, in bytes
+ */
+typedef struct memstat {
+  size_t inuse;
+  size_t peak;
+} memstat_t;
+
 
 #endif /* DEFS_H */
 
@@ -0,0 +1,114 @@
+/**
+ * @brief Double-ended queue built from a ring of fixed-size blocks.
+ *
+ * @details
+ * Items live in blocks of `DEQUE_BLOCKSIZE` pointers, and a circular map of block pointers
+ * grows at either end. Pushing and popping at both ends is amortized O(1), indexed access is
+ * O(1), and no memory is allocated per item. One emptied block is kept as a spare, so a queue
+ * in steady state (add at one end, pop at the other) does not allocate at all.
+ *
+ * Semantics follow `list.h`: adding a `NULL` item fails, and popping an empty deque panics.
+ */
+
+#ifndef DEQUE_H
+#define DEQUE_H
+
+#include "defs.h"
+
+#include <stdlib.h>
+
+/* items per block, must be a power of two */
+#define DEQUE_BLOCKSIZE 64
+
+struct deque;
+
+/**
+ * Type of deque. `deque_t` is an alias for `struct deque`
+ */
+typedef struct deque deque_t;
+
+/**
+ * @brief Create a new, empty deque that uses the given comparison function
+ * @param cmpfn: reference to comparison function
+ * @returns A pointer to the newly allocated deque, or `NULL` on failure.
+ */
+deque_t *deque_create(cmp_fn cmpfn);
+
+/**
+ * @brief Create a new, empty deque that allocates its blocks with the given allocator
+ * @param cmpfn: reference to comparison function
+ * @param allocator: nullable. The struct is copied. If `NULL`, malloc/free are used
+ * @returns A pointer to the newly allocated deque, or `NULL` on failure.
+ */
+deque_t *deque_create_with_allocator(cmp_fn cmpfn, const allocator_t *allocator);
+
+/**
+ * @brief Destroy a deque, and optionally its items.
+ * @param dq: pointer to deque
+ * @param item_free: nullable. If present, called on all items
+ */
+void deque_destroy(deque_t *dq, free_fn item_free);
+
+/**
+ * @brief Get the number of items in a given deque
+ * @param dq: pointer to deque
+ * @returns Number of items in `dq`
+ */
+size_t deque_length(deque_t *dq);
+
+/**
+ * @brief Get the memory used by a deque itself, not its items
+ * @param dq: pointer to deque
+ * @param stat: set to the bytes currently in use, and the peak over the lifetime of the deque
+ */
+void deque_memstat(deque_t *dq, memstat_t *stat);
+
+/**
+ * @brief Add an item to the front of the given deque
+ * @param dq: pointer to deque
+ * @param item: pointer to item to be added
+ * @returns 0 on success, otherwise a negative error code
+ */
+int deque_addfirst(deque_t *dq, void *item);
+
+/**
+ * @brief Add an item to the back of the given deque
+ * @param dq: pointer to deque
+ * @param item: pointer to item to be added
+ * @returns 0 on success, otherwise a negative error code
+ */
+int deque_addlast(deque_t *dq, void *item);
+
+/**
+ * @brief Remove the first item from the given deque
+ * @param dq: pointer to deque
+ * @returns A pointer to the removed item
+ * @warning panics if deque is empty
+ */
+void *deque_popfirst(deque_t *dq);
+
+/**
+ * @brief Remove the last item from the given deque
+ * @param dq: pointer to deque
+ * @returns A pointer to the removed item
+ * @warning panics if deque is empty
+ */
+void *deque_poplast(deque_t *dq);
+
+/**
+ * @brief Get the item at the given index
+ * @param dq: pointer to deque
+ * @param index: index of item, where 0 is the first
+ * @returns A pointer to the item, or `NULL` if `index` is out of bounds
+ */
+void *deque_get(deque_t *dq, size_t index);
+
+/**
+ * @brief Search for an item in the given deque
+ * @param dq: pointer to deque
+ * @param item: pointer to an item that compares as equal, using the deque cmpfn
+ * @returns 1 if the item was found, otherwise 0
+ */
+int deque_contains(deque_t *dq, void *item);
+
+#endif /* DEQUE_H */
@@ -0,0 +1,139 @@
+/**
+ * @brief Epoch-based memory reclamation for lock-free structures, with hazard pointers for
+ * long-running readers.
+ *
+ * @details
+ * A node removed from a lock-free structure may still be read by threads that found it
+ * before it was unlinked. Instead of freeing it right away, the remover passes it to
+ * `ebr_retire`, and it is freed once no thread can still hold a reference:
+ *
+ * - Readers access the structure between `ebr_enter` and `ebr_exit`. A global epoch only
+ *   advances once every thread inside such a critical section has seen the current epoch,
+ *   and a node retired in epoch `e` is freed once the global epoch reaches `e + 2`. Entering
+ *   and exiting is one atomic exchange and one store on a thread-local cache line.
+ *
+ * - A reader inside a critical section holds back reclamation for everyone. A reader that
+ *   may run for long, e.g. one that blocks, can instead publish the few nodes it holds in
+ *   hazard pointers with `ebr_protect`. Protected nodes are never freed, regardless of the
+ *   epoch, and the reader does not delay the epoch while outside a critical section.
+ *
+ * Retired nodes are kept in a per-thread list and reclaimed in batches of
+ * `EBR_RETIRE_BATCH`, when the thread retires or calls `ebr_collect`.
+ *
+ * ```
+ * ebr_enter(thr);
+ * for (node_t *n = atomic_load(&list->head); ...)   // nodes stay valid until ebr_exit
+ * ebr_exit(thr);
+ *
+ * if (atomic_compare_exchange_strong(&prev->next, &node, node->next)) {
+ *     ebr_retire(thr, node, free);
+ * }
+ * ```
+ */
+
+#ifndef EBR_H
+#define EBR_H
+
+#include "defs.h"
+
+#include <stdlib.h>
+
+/* number of retired nodes that are batched before a thread tries to reclaim them */
+#define EBR_RETIRE_BATCH 64
+
+/* number of hazard pointers per thread */
+#define EBR_HAZARDS 4
+
+struct ebr;
+
+/**
+ * Type of reclamation domain. `ebr_t` is an alias for `struct ebr`
+ */
+typedef struct ebr ebr_t;
+
+/**
+ * Type of per-thread registration. `ebr_thread_t` is an alias for `struct ebr_thread`
+ */
+typedef struct ebr_thread ebr_thread_t;
+
+/**
+ * @brief Create a new reclamation domain, usually one per structure or per program
+ * @returns A pointer to the newly allocated domain, or `NULL` on failure.
+ */
+ebr_t *ebr_create(void);
+
+/**
+ * @brief Free everything still retired, and destroy the domain. All threads must be
+ * unregistered.
+ * @param ebr: pointer to domain
+ */
+void ebr_destroy(ebr_t *ebr);
+
+/**
+ * @brief Register the calling thread with a domain
+ * @param ebr: pointer to domain
+ * @returns A pointer to the registration, to be used only by the calling thread, or `NULL`
+ * on failure.
+ */
+ebr_thread_t *ebr_register(ebr_t *ebr);
+
+/**
+ * @brief Unregister a thread. Its retired nodes are handed to the other threads of the domain
+ * @param thr: pointer to registration. Must be outside a critical section
+ */
+void ebr_unregister(ebr_thread_t *thr);
+
+/**
+ * @brief Enter a critical section. Nodes read inside stay valid until the matching `ebr_exit`
+ * @param thr: pointer to registration
+ * @note Critical sections nest.
+ */
+void ebr_enter(ebr_thread_t *thr);
+
+/**
+ * @brief Exit a critical section
+ * @param thr: pointer to registration
+ */
+void ebr_exit(ebr_thread_t *thr);
+
+/**
+ * @brief Free a node once no thread can hold a reference to it anymore
+ * @param thr: pointer to registration
+ * @param ptr: pointer to a node that is no longer reachable from the structure
+ * @param item_free: called with `ptr` to free it, on whichever thread reclaims it
+ * @note May be called inside or outside a critical section.
+ */
+void ebr_retire(ebr_thread_t *thr, void *ptr, free_fn item_free);
+
+/**
+ * @brief Try to advance the epoch and free the calling thread's reclaimable nodes now
+ * @param thr: pointer to registration
+ * @returns Number of nodes retired by the calling thread that are still waiting
+ * @note Inside a critical section, the calling thread holds back its own reclamation.
+ */
+size_t ebr_collect(ebr_thread_t *thr);
+
+/**
+ * @brief Publish a node in a hazard pointer, so that it is not freed until unprotected
+ * @param thr: pointer to registration
+ * @param slot: hazard pointer to use, below `EBR_HAZARDS`
+ * @param ptr: pointer to node
+ * @warning Outside a critical section, the node may have been retired before it was
+ * published. Re-read the link `ptr` was loaded from, and retry if it changed:
+ * ```
+ * do {
+ *     node = atomic_load(&prev->next);
+ *     ebr_protect(thr, 0, node);
+ * } while (node != atomic_load(&prev->next));
+ * ```
+ */
+void ebr_protect(ebr_thread_t *thr, size_t slot, void *ptr);
+
+/**
+ * @brief Clear a hazard pointer
+ * @param thr: pointer to registration
+ * @param slot: hazard pointer to clear, below `EBR_HAZARDS`
+ */
+void ebr_unprotect(ebr_thread_t *thr, size_t slot);
+
+#endif /* EBR_H */
@@ -0,0 +1,117 @@
+/**
+ * @brief External merge sort for datasets that do not fit in memory.
+ *
+ * @details
+ * Items are pushed one at a time. While the pushed items fit within the memory budget
+ * they are kept in a `list_t`. When the budget is exceeded, the list is sorted with
+ * `list_sort` and spilled to a temporary file as a sorted run. Once all items are pushed,
+ * `extsort_finish` k-way merges the runs with a loser tree, and the sorted items are
+ * read back with `extsort_hasnext` / `extsort_next`, in the same manner as a list iterator.
+ *
+ * If nothing was spilled, the items are sorted in memory and no files are created.
+ */
+
+#ifndef EXTSORT_H
+#define EXTSORT_H
+
+#include "defs.h"
+
+#include <stdlib.h>
+
+/**
+ * @brief Serializer used to spill items to disk and read them back
+ */
+typedef struct extsort_codec {
+  /**
+   * @brief Encode `item` into `buf` if the encoding fits in `size` bytes
+   * @returns Number of bytes needed to encode `item`, regardless of whether it fit.
+   * `buf` may be `NULL` when `size` is 0.
+   */
+  size_t (*encode)(const void *item, void *buf, size_t size);
+
+  /**
+   * @brief Create a new item from `size` bytes previously written by `encode`
+   * @returns A pointer to the new item, or `NULL` on failure
+   */
+  void *(*decode)(const void *buf, size_t size);
+} extsort_codec_t;
+
+struct extsort;
+
+/**
+ * Type of external sorter. `extsort_t` is an alias for `struct extsort`
+ */
+typedef struct extsort extsort_t;
+
+/**
+ * @brief Create a new external sorter
+ * @param cmpfn: reference to comparison function
+ * @param codec: pointer to serializer. The struct is copied.
+ * @param budget: approximate number of bytes of items to hold in memory at once.
+ * Items are accounted by their encoded size plus `EXTSORT_ITEM_OVERHEAD`.
+ * @param item_free: called on pushed items once they are spilled, and on decoded items
+ * that are consumed internally by intermediate merge passes
+ * @returns A pointer to the newly allocated sorter, or `NULL` on failure.
+ */
+extsort_t *extsort_create(cmp_fn cmpfn, const extsort_codec_t *codec, size_t budget,
+                          free_fn item_free);
+
+/**
+ * @brief Destroy a sorter, its temporary files, and any items not yet returned by `extsort_next`
+ * @param es: pointer to sorter
+ */
+void extsort_destroy(extsort_t *es);
+
+/**
+ * @brief Push an item to be sorted. The sorter takes ownership of the item.
+ * @param es: pointer to sorter
+ * @param item: pointer to item
+ * @returns 0 on success, otherwise a negative error code
+ * @note Fails if called after `extsort_finish`
+ */
+int extsort_push(extsort_t *es, void *item);
+
+/**
+ * @brief Sort all pushed items and prepare them for reading
+ * @param es: pointer to sorter
+ * @returns 0 on success, otherwise a negative error code
+ */
+int extsort_finish(extsort_t *es);
+
+/**
+ * @brief Check if there are more sorted items to read
+ * @param es: pointer to a finished sorter
+ * @returns 0 if all items have been read or a run could not be read back, otherwise 1
+ */
+int extsort_hasnext(extsort_t *es);
+
+/**
+ * @brief Get the next item in sorted order. Ownership of the item passes to the caller.
+ * @param es: pointer to a finished sorter
+ * @returns A pointer to the next item, or `NULL` if all items have been read or a run could
+ * not be read back. Check `extsort_error` to tell the two apart
+ */
+void *extsort_next(extsort_t *es);
+
+/**
+ * @brief Check if reading back a spilled run failed, on a read error, a truncated record or
+ * a failed `decode`. The remaining items are then lost, and the output is incomplete
+ * @param es: pointer to sorter
+ * @returns 1 if a run could not be read back, otherwise 0
+ */
+int extsort_error(extsort_t *es);
+
+/**
+ * @brief Get the number of runs that were spilled to disk
+ * @param es: pointer to sorter
+ * @returns Number of runs written, including runs written by intermediate merge passes
+ */
+size_t extsort_runs(extsort_t *es);
+
+/* approximate in-memory overhead of a pending item, in addition to its encoded size */
+#define EXTSORT_ITEM_OVERHEAD (4 * sizeof(void *))
+
+/* smallest I/O buffer used per run when merging */
+#define EXTSORT_MIN_IOBUF (64 * 1024)
+
+#endif /* EXTSORT_H */
@@ -0,0 +1,170 @@
+/**
+ * @brief Compact doubly linked list whose nodes live in one array and link by 32-bit index.
+ *
+ * @details
+ * A node is 16 bytes (two 32-bit links and the item pointer) with no per-node allocation
+ * header, against 24 bytes plus the malloc header for a `list_t` node. Freed nodes are reused
+ * through a free list. `ilist_compact` re-lays the nodes in traversal order, so that walking
+ * the list reads the array sequentially. A list holds at most `ILIST_MAXLEN` items.
+ *
+ * The interface follows `list.h`.
+ */
+
+#ifndef ILIST_H
+#define ILIST_H
+
+#include "defs.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/* most items in one list, since index UINT32_MAX marks the end of a chain */
+#define ILIST_MAXLEN ((size_t) UINT32_MAX - 1)
+
+struct ilist;
+
+/**
+ * Type of index list. `ilist_t` is an alias for `struct ilist`
+ */
+typedef struct ilist ilist_t;
+
+/**
+ * @brief Create a new, empty list that uses the given comparison function
+ * @param cmpfn: reference to comparison function
+ * @returns A pointer to the newly allocated list, or `NULL` on failure.
+ */
+ilist_t *ilist_create(cmp_fn cmpfn);
+
+/**
+ * @brief Create a new, empty list that allocates its node array with the given allocator
+ * @param cmpfn: reference to comparison function
+ * @param allocator: nullable. The struct is copied. If `NULL`, malloc/free are used
+ * @returns A pointer to the newly allocated list, or `NULL` on failure.
+ * @note Iterators always use malloc/free, so that they may outlive the list and its allocator.
+ */
+ilist_t *ilist_create_with_allocator(cmp_fn cmpfn, const allocator_t *allocator);
+
+/**
+ * @brief Destroy a list, and optionally its items.
+ * @param list: pointer to list
+ * @param item_free: nullable. If present, called on all items
+ */
+void ilist_destroy(ilist_t *list, free_fn item_free);
+
+/**
+ * @brief Get the number of items in a given list
+ * @param list: pointer to list
+ * @returns Number of items in `list`
+ */
+size_t ilist_length(ilist_t *list);
+
+/**
+ * @brief Get the memory used by a list itself (the list and its node array), not its items or iterators
+ * @param list: pointer to list
+ * @param stat: set to the bytes currently in use, and the peak over the lifetime of the list
+ */
+void ilist_memstat(ilist_t *list, memstat_t *stat);
+
+/**
+ * @brief Add an item to the start of the given list
+ * @param list: pointer to list
+ * @param item: pointer to item to be added
+ * @returns 0 on success, otherwise a negative error code
+ */
+int ilist_addfirst(ilist_t *list, void *item);
+
+/**
+ * @brief Add an item to the end of the given list
+ * @param list: pointer to list
+ * @param item: pointer to item to be added
+ * @returns 0 on success, otherwise a negative error code
+ */
+int ilist_addlast(ilist_t *list, void *item);
+
+/**
+ * @brief Remove the first item from the given list
+ * @param list: pointer to list
+ * @returns A pointer to the removed item
+ * @warning panics if list is empty
+ */
+void *ilist_popfirst(ilist_t *list);
+
+/**
+ * @brief Remove the last item from the given list
+ * @param list: pointer to list
+ * @returns A pointer to the removed item
+ * @warning panics if list is empty
+ */
+void *ilist_poplast(ilist_t *list);
+
+/**
+ * @brief Removes the first occurrence of an item from the list, using the comparison function
+ * @param list: pointer to list
+ * @param item: pointer to an item that compares as equal, using the list cmpfn
+ * @returns A pointer to the removed item, or `NULL` if not found
+ */
+void *ilist_remove(ilist_t *list, void *item);
+
+/**
+ * @brief Search for an item in the given list
+ * @param list: pointer to list
+ * @param item: pointer to an item that compares as equal, using the list cmpfn
+ * @returns 1 if the item was found, otherwise 0
+ */
+int ilist_contains(ilist_t *list, void *item);
+
+/**
+ * @brief Sorts the items of the given list in ascending order by relinking its nodes, using
+ * the comparison function of the list
+ * @param list: pointer to list
+ */
+void ilist_sort(ilist_t *list);
+
+/**
+ * @brief Re-lay the nodes in traversal order and shrink the node array to fit
+ * @param list: pointer to list
+ * @returns 0 on success, otherwise a negative error code. The list is unchanged on failure
+ * @warning invalidates the position of all iterators of the list, which must be reset
+ */
+int ilist_compact(ilist_t *list);
+
+/**
+ * Type of list iterator. `ilist_iter_t` is an alias for `struct ilist_iter`
+ */
+typedef struct ilist_iter ilist_iter_t;
+
+/**
+ * @brief Create an iterator for the given list
+ * @param list: pointer to list
+ * @returns A pointer to the newly allocated iterator, or `NULL` on failure.
+ */
+ilist_iter_t *ilist_createiter(ilist_t *list);
+
+/**
+ * @brief Destroy a list iterator. Does not free the underlying list, and may be called after it
+ * was destroyed
+ * @param iter: pointer to iterator
+ */
+void ilist_destroyiter(ilist_iter_t *iter);
+
+/**
+ * @brief Check if the given list iterator has reached the end of the underlying list
+ * @param iter: pointer to iterator
+ * @returns 0 if iterator is exhausted, otherwise 1
+ */
+int ilist_hasnext(ilist_iter_t *iter);
+
+/**
+ * @brief Get the next item from the underlying list
+ * @param iter: pointer to iterator
+ * @returns A pointer to the next item
+ */
+void *ilist_next(ilist_iter_t *iter);
+
+/**
+ * @brief Reset the given iterator to the first item in the underlying list
+ * @param iter: pointer to iterator
+ */
+void ilist_resetiter(ilist_iter_t *iter);
+
+#endif /* ILIST_H */
@@ -8,7 +8,9 @@
 #ifndef LIST_H
 #define LIST_H
 
+#include "bloom.h"
 #include "defs.h"
+#include "threadpool.h"
 
 #include <stdlib.h>
 
@@ -27,6 +29,17 @@ typedef struct list list_t;
  */
 list_t *list_create(cmp_fn cmpfn);
 
+/**
+ * @brief Create a new, empty list that allocates itself, its nodes and its filter with the
+ * given allocator
+ * @param cmpfn: reference to comparison function
+ * @param allocator: nullable. The struct is copied. If `NULL`, malloc/free are used
+ * @returns A pointer to the newly allocated list, or `NULL` on failure.
+ * @note Iterators are the exception: they always use malloc/free, so that they may outlive the
+ * list and its allocator (e.g. an arena). They are not counted by `list_memstat`.
+ */
+list_t *list_create_with_allocator(cmp_fn cmpfn, const allocator_t *allocator);
+
 /**
  * @brief Destroy a list, and optionally its items.
  * @param list: pointer to list
@@ -41,6 +54,35 @@ void list_destroy(list_t *list, free_fn item_free);
  */
 size_t list_length(list_t *list);
 
+/**
+ * @brief Get the memory used by a list itself (the list, its nodes and filter), not its items or iterators
+ * @param list: pointer to list
+ * @param stat: set to the bytes currently in use, and the peak over the lifetime of the list. The
+ * filter is counted as part of the list, so the peak is that of their sum
+ */
+void list_memstat(list_t *list, memstat_t *stat);
+
+/**
+ * @brief Attach a Bloom filter to the list, so that `list_contains` and `list_remove` return
+ * early for items that are definitely not in the list. Replaces any filter already attached.
+ * @param list: pointer to list
+ * @param hashfn: nullable. Hash function consistent with the list cmpfn, so that items that
+ * compare as equal hash equal. If `NULL`, the filter is detached
+ * @param fprate: target false-positive rate of the filter, between 0 and 1 exclusive
+ * @returns 0 on success, otherwise a negative error code
+ * @note The filter is sized for twice the current items and rebuilt from the list when adds
+ * exceed that. Removed items stay in the filter until the next rebuild.
+ */
+int list_setfilter(list_t *list, hash64_fn hashfn, double fprate);
+
+/**
+ * @brief Get the statistics of the filter attached to the list
+ * @param list: pointer to list
+ * @param stats: set to the current statistics of the filter
+ * @returns 0 on success, or a negative error code if no filter is attached
+ */
+int list_filterstats(list_t *list, bloom_stats_t *stats);
+
 /**
  * @brief Add an item to the start of the given list
  * @param list: pointer to list
@@ -112,7 +154,8 @@ typedef struct list_iter list_iter_t;
 list_iter_t *list_createiter(list_t *list);
 
 /**
- * @brief Destroy a list iterator. Does not free the underlying list
+ * @brief Destroy a list iterator. Does not free the underlying list, and may be called after it
+ * was destroyed
  * @param iter: pointer to iterator
  */
 void list_destroyiter(list_iter_t *iter);
@@ -137,5 +180,86 @@ void *list_next(list_iter_t *iter);
  */
 void list_resetiter(list_iter_t *iter);
 
+
+
+/* ---- parallel operations ---- */
+
+
+/**
+ * @brief Type of function applied to every item by `list_foreach`
+ */
+typedef void (*list_foreach_fn)(void *item, void *ctx);
+
+/**
+ * @brief Type of function that maps an item to a new item for `list_map`
+ */
+typedef void *(*list_map_fn)(void *item, void *ctx);
+
+/**
+ * @brief Type of predicate for `list_filter`. Returns non-zero to keep the item
+ */
+typedef int (*list_pred_fn)(void *item, void *ctx);
+
+/**
+ * @brief Type of function that folds `item` into the accumulator `acc`, for `list_reduce`
+ */
+typedef void (*list_reduce_fn)(void *acc, void *item, void *ctx);
+
+/*
+ * The functions below cut the list into segments of equal length, a few per thread of the
+ * pool, and process the segments as tasks on the pool. The list must not be modified while
+ * they run. `fn` may run on any thread of the pool, concurrently for different items.
+ * If `pool` is `NULL`, everything runs on the calling thread.
+ */
+
+/**
+ * @brief Call a function on every item of the list, in parallel
+ * @param pool: nullable. Thread pool to run on
+ * @param list: pointer to list
+ * @param fn: function called on every item, in no particular order
+ * @param ctx: nullable. Passed to `fn`
+ * @returns 0 on success, otherwise a negative error code
+ */
+int list_foreach(threadpool_t *pool, list_t *list, list_foreach_fn fn, void *ctx);
+
+/**
+ * @brief Create a new list of the results of a function on every item, in parallel
+ * @param pool: nullable. Thread pool to run on
+ * @param list: pointer to list
+ * @param fn: function mapping an item to a non-`NULL` result
+ * @param ctx: nullable. Passed to `fn`
+ * @param cmpfn: comparison function of the new list
+ * @returns A new list with the results in the order of their items, or `NULL` on failure.
+ * The new list uses the allocator of `list`
+ */
+list_t *list_map(threadpool_t *pool, list_t *list, list_map_fn fn, void *ctx, cmp_fn cmpfn);
+
+/**
+ * @brief Create a new list of the items that satisfy a predicate, in parallel
+ * @param pool: nullable. Thread pool to run on
+ * @param list: pointer to list
+ * @param pred: predicate, non-zero to keep the item
+ * @param ctx: nullable. Passed to `pred`
+ * @returns A new list with the kept items in their original order, or `NULL` on failure.
+ * The new list uses the comparison function and allocator of `list`
+ */
+list_t *list_filter(threadpool_t *pool, list_t *list, list_pred_fn pred, void *ctx);
+
+/**
+ * @brief Reduce the items of the list to a single value, in parallel
+ * @param pool: nullable. Thread pool to run on
+ * @param list: pointer to list
+ * @param fold: folds an item into an accumulator
+ * @param combine: folds the accumulator passed as its `item` into `acc`. Called in list order,
+ * so it must be associative, but need not be commutative
+ * @param acc: accumulator of `accsize` bytes. Must hold the identity of `combine` on entry,
+ * and holds the result on return
+ * @param accsize: size of the accumulator in bytes
+ * @param ctx: nullable. Passed to `fold` and `combine`
+ * @returns 0 on success, otherwise a negative error code
+ */
+int list_reduce(threadpool_t *pool, list_t *list, list_reduce_fn fold, list_reduce_fn combine,
+                void *acc, size_t accsize, void *ctx);
+
 #endif /* LIST_H */
 
@@ -0,0 +1,31 @@
+/**
+ * @brief Pattern-defeating quicksort (Orson Peters). Unstable, O(n log n) worst case, and
+ * linear time on sorted, reverse sorted and many-duplicate inputs.
+ */
+
+#ifndef PDQSORT_H
+#define PDQSORT_H
+
+#include "defs.h"
+
+#include <stdlib.h>
+
+/**
+ * @brief Sort an array in ascending order, with the same interface as `qsort`
+ * @param base: pointer to first element
+ * @param nmemb: number of elements
+ * @param size: size of each element in bytes
+ * @param cmpfn: comparison function, called with pointers to two elements
+ */
+void pdqsort(void *base, size_t nmemb, size_t size, cmp_fn cmpfn);
+
+/**
+ * @brief Sort an array of item pointers in ascending order
+ * @param items: array of item pointers
+ * @param nmemb: number of items
+ * @param cmpfn: comparison function, called with two items (not pointers to the array slots),
+ * as for the comparison function of a `list_t`
+ */
+void pdqsort_items(void **items, size_t nmemb, cmp_fn cmpfn);
+
+#endif /* PDQSORT_H */
@@ -0,0 +1,102 @@
+/**
+ * @brief Hardware performance counters around a code region, via `perf_event_open`.
+ *
+ * @details
+ * Cycles, instructions, L1 data cache read misses, last-level cache misses and branch
+ * misses are opened as one group, so that they are scheduled onto the PMU together and
+ * their ratios are consistent. If the kernel multiplexes the group with other events, the
+ * counts are scaled up to the whole region.
+ *
+ * Counters that cannot be opened (no PMU in a VM, `perf_event_paranoid` too strict, or an
+ * event the CPU lacks) are left out, and their bit in `perf_sample_t.valid` is clear. The
+ * wall-clock time is always measured.
+ *
+ * ```
+ * perf_t *perf = perf_create();
+ * perf_start(perf);
+ * ...
+ * perf_stop(perf, &sample);
+ * perf_format(&sample, nelems, buf, sizeof buf);   // "1.2 cyc 3.4 ins ..." per element
+ * ```
+ *
+ * Only the calling thread is counted, not threads it starts or hands work to.
+ */
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Counters of a group
+ */
+typedef enum perf_counter {
+  PERF_CYCLES,
+  PERF_INSTRUCTIONS,
+  PERF_L1DMISSES,
+  PERF_LLCMISSES,
+  PERF_BRANCHMISSES,
+  PERF_NCOUNTERS,
+} perf_counter_t;
+
+/**
+ * @brief Measurements of one region
+ */
+typedef struct perf_sample {
+  double seconds;
+  uint64_t counts[PERF_NCOUNTERS];
+  unsigned valid;           /* bit `1 << counter` is set for every counter that was measured */
+} perf_sample_t;
+
+struct perf;
+
+/**
+ * Type of counter group. `perf_t` is an alias for `struct perf`
+ */
+typedef struct perf perf_t;
+
+/**
+ * @brief Open the counters for the calling thread
+ * @returns A pointer to the newly allocated group, or `NULL` on failure. Having no
+ * counters available is not a failure
+ */
+perf_t *perf_create(void);
+
+/**
+ * @brief Close the counters and destroy the group
+ * @param perf: pointer to group
+ */
+void perf_destroy(perf_t *perf);
+
+/**
+ * @brief Get the counters that could be opened
+ * @param perf: pointer to group
+ * @returns Bit `1 << counter` is set for every counter of `perf_counter_t` that is available
+ */
+unsigned perf_available(perf_t *perf);
+
+/**
+ * @brief Reset the counters and start counting
+ * @param perf: pointer to group. Must be used from the thread that created it
+ */
+void perf_start(perf_t *perf);
+
+/**
+ * @brief Stop counting and read the counters
+ * @param perf: pointer to group
+ * @param sample: set to the time and counts since `perf_start`
+ */
+void perf_stop(perf_t *perf, perf_sample_t *sample);
+
+/**
+ * @brief Format the measured counters of a sample, divided by a number of elements
+ * @param sample: pointer to sample
+ * @param nelems: number of elements processed. If 0, the counts are not divided
+ * @param buf: buffer to write to. Set to the empty string if no counter was measured
+ * @param size: size of `buf`
+ * @returns Number of characters written, as by `snprintf`
+ */
+int perf_format(const perf_sample_t *sample, size_t nelems, char *buf, size_t size);
+
+#endif /* PERF_H */
@@ -0,0 +1,119 @@
+/**
+ * @brief Priority queue built on a cache-aligned 4-ary heap, ordered by a `cmp_fn`.
+ *
+ * @details
+ * The smallest item according to the comparison function is at the front. Push and pop are
+ * O(log n), peek is O(1), and `pqueue_heapify` builds the queue from an array in O(n).
+ *
+ * Heap entries are 16 bytes and the array is laid out so that the four children of a node
+ * share one 64-byte cache line, so each level of a sift-down touches a single line.
+ *
+ * Pushing an item can return a handle that stays valid until the item is popped. After making
+ * an item compare smaller, pass its handle to `pqueue_decreasekey` to restore the heap order.
+ * Items pushed without a handle are not tracked, which saves a store per level moved.
+ */
+
+#ifndef PQUEUE_H
+#define PQUEUE_H
+
+#include "defs.h"
+
+#include <stdlib.h>
+
+/* children per node */
+#define PQUEUE_ARITY 4
+
+struct pqueue;
+
+/**
+ * Type of priority queue. `pqueue_t` is an alias for `struct pqueue`
+ */
+typedef struct pqueue pqueue_t;
+
+/**
+ * Type of handle to an item in a priority queue
+ */
+typedef size_t pqueue_handle_t;
+
+/**
+ * @brief Create a new, empty priority queue that uses the given comparison function
+ * @param cmpfn: reference to comparison function
+ * @returns A pointer to the newly allocated priority queue, or `NULL` on failure.
+ */
+pqueue_t *pqueue_create(cmp_fn cmpfn);
+
+/**
+ * @brief Create a new, empty priority queue that allocates its storage with the given allocator
+ * @param cmpfn: reference to comparison function
+ * @param allocator: nullable. The struct is copied. If `NULL`, malloc/free are used
+ * @returns A pointer to the newly allocated priority queue, or `NULL` on failure.
+ */
+pqueue_t *pqueue_create_with_allocator(cmp_fn cmpfn, const allocator_t *allocator);
+
+/**
+ * @brief Destroy a priority queue, and optionally its items.
+ * @param pq: pointer to priority queue
+ * @param item_free: nullable. If present, called on all items
+ */
+void pqueue_destroy(pqueue_t *pq, free_fn item_free);
+
+/**
+ * @brief Get the number of items in a given priority queue
+ * @param pq: pointer to priority queue
+ * @returns Number of items in `pq`
+ */
+size_t pqueue_length(pqueue_t *pq);
+
+/**
+ * @brief Get the memory used by a priority queue itself, not its items
+ * @param pq: pointer to priority queue
+ * @param stat: set to the bytes currently in use, and the peak over the lifetime of the queue
+ */
+void pqueue_memstat(pqueue_t *pq, memstat_t *stat);
+
+/**
+ * @brief Add an item to the given priority queue
+ * @param pq: pointer to priority queue
+ * @param item: pointer to item to be added
+ * @param handle: nullable. Set to a handle for the item, valid until it is popped. If `NULL`,
+ * the item cannot be passed to `pqueue_decreasekey`
+ * @returns 0 on success, otherwise a negative error code
+ */
+int pqueue_push(pqueue_t *pq, void *item, pqueue_handle_t *handle);
+
+/**
+ * @brief Add many items at once, restoring the heap order in a single O(n) pass
+ * @param pq: pointer to priority queue
+ * @param items: array of `n` item pointers
+ * @param n: number of items
+ * @param handles: nullable. Array of `n` handles, set to the handle of each item. If `NULL`,
+ * the items cannot be passed to `pqueue_decreasekey`
+ * @returns 0 on success, otherwise a negative error code. On failure no items are added
+ */
+int pqueue_heapify(pqueue_t *pq, void **items, size_t n, pqueue_handle_t *handles);
+
+/**
+ * @brief Remove the smallest item from the given priority queue
+ * @param pq: pointer to priority queue
+ * @returns A pointer to the removed item
+ * @warning panics if priority queue is empty
+ */
+void *pqueue_pop(pqueue_t *pq);
+
+/**
+ * @brief Get the smallest item without removing it
+ * @param pq: pointer to priority queue
+ * @returns A pointer to the smallest item, or `NULL` if the queue is empty
+ */
+void *pqueue_peek(pqueue_t *pq);
+
+/**
+ * @brief Restore the heap order after the item behind `handle` was changed to compare smaller
+ * @param pq: pointer to priority queue
+ * @param handle: handle returned when the item was added
+ * @returns 0 on success, or a negative error code if `handle` does not refer to a queued item
+ * @warning handles of popped items may be reused by later pushes
+ */
+int pqueue_decreasekey(pqueue_t *pq, pqueue_handle_t handle);
+
+#endif /* PQUEUE_H */
@@ -0,0 +1,142 @@
+/**
+ * @brief Persistent vector of item pointers with O(1) snapshots.
+ *
+ * @details
+ * Items live in a 32-way trie of reference counted nodes, plus a tail leaf holding the last
+ * up to 32 items. `pvec_snapshot` returns a new version that shares every node with the
+ * original, which only bumps two reference counts. Afterwards, an update to either version
+ * copies the nodes on the path it touches that are still shared, and writes uniquely owned
+ * nodes in place, so a writer that never snapshots pays no copying at all. Nodes are freed
+ * when the last version referencing them is destroyed.
+ *
+ * Access by index takes O(log32 n), at most 4 levels below 1M items. Appending and popping
+ * at the end only touch the tail, except once every 32 items.
+ *
+ * ```
+ * pvec_t *snap = pvec_snapshot(vec);   // hand to a reader
+ * pvec_addlast(vec, item);             // does not affect snap
+ * ```
+ *
+ * A single version must not be used from several threads at once, but different versions
+ * may be, including versions sharing nodes. Nodes are allocated with malloc, since versions
+ * are usually destroyed on other threads than the one that created them.
+ */
+
+#ifndef PVEC_H
+#define PVEC_H
+
+#include "defs.h"
+
+#include <stdlib.h>
+
+#define PVEC_BITS   5
+#define PVEC_BRANCH (1 << PVEC_BITS)
+
+struct pvec;
+
+/**
+ * Type of persistent vector version. `pvec_t` is an alias for `struct pvec`
+ */
+typedef struct pvec pvec_t;
+
+/**
+ * @brief Create a new, empty persistent vector
+ * @returns A pointer to the newly allocated vector, or `NULL` on failure.
+ */
+pvec_t *pvec_create(void);
+
+/**
+ * @brief Destroy a version. Nodes shared with other versions stay alive. Items are not
+ * freed, since other versions may still hold them.
+ * @param vec: pointer to version
+ */
+void pvec_destroy(pvec_t *vec);
+
+/**
+ * @brief Take an immutable snapshot of a version in O(1)
+ * @param vec: pointer to version
+ * @returns A new version with the same items, or `NULL` on failure. Destroy it with
+ * `pvec_destroy`
+ */
+pvec_t *pvec_snapshot(pvec_t *vec);
+
+/**
+ * @brief Get the number of items in a given version
+ * @param vec: pointer to version
+ * @returns Number of items in `vec`
+ */
+size_t pvec_length(pvec_t *vec);
+
+/**
+ * @brief Get the item at the given index
+ * @param vec: pointer to version
+ * @param index: index of the item
+ * @returns A pointer to the item, or `NULL` if `index` is out of bounds
+ */
+void *pvec_get(pvec_t *vec, size_t index);
+
+/**
+ * @brief Replace the item at the given index. Other versions are unaffected
+ * @param vec: pointer to version
+ * @param index: index of the item
+ * @param item: pointer to the new item
+ * @returns 0 on success, otherwise a negative error code
+ */
+int pvec_set(pvec_t *vec, size_t index, void *item);
+
+/**
+ * @brief Add an item to the end of the given version. Other versions are unaffected
+ * @param vec: pointer to version
+ * @param item: pointer to item to be added
+ * @returns 0 on success, otherwise a negative error code
+ */
+int pvec_addlast(pvec_t *vec, void *item);
+
+/**
+ * @brief Remove the last item from the given version. Other versions are unaffected
+ * @param vec: pointer to version
+ * @returns A pointer to the removed item, or `NULL` if the trie could not be copied
+ * @warning panics if vec is empty
+ */
+void *pvec_poplast(pvec_t *vec);
+
+/**
+ * Type of vector iterator. `pvec_iter_t` is an alias for `struct pvec_iter`
+ */
+typedef struct pvec_iter pvec_iter_t;
+
+/**
+ * @brief Create an iterator for the given version
+ * @param vec: pointer to version
+ * @returns A pointer to the newly allocated iterator, or `NULL` on failure.
+ * @warning the iterator is invalidated by updates of `vec`. Iterate a snapshot instead.
+ */
+pvec_iter_t *pvec_createiter(pvec_t *vec);
+
+/**
+ * @brief Destroy a vector iterator. Does not free the underlying version
+ * @param iter: pointer to iterator
+ */
+void pvec_destroyiter(pvec_iter_t *iter);
+
+/**
+ * @brief Check if the given iterator has reached the end of the underlying version
+ * @param iter: pointer to iterator
+ * @returns 0 if iterator is exhausted, otherwise 1
+ */
+int pvec_hasnext(pvec_iter_t *iter);
+
+/**
+ * @brief Get the next item from the underlying version
+ * @param iter: pointer to iterator
+ * @returns A pointer to the next item
+ */
+void *pvec_next(pvec_iter_t *iter);
+
+/**
+ * @brief Reset the given iterator to the first item in the underlying version
+ * @param iter: pointer to iterator
+ */
+void pvec_resetiter(pvec_iter_t *iter);
+
+#endif /* PVEC_H */
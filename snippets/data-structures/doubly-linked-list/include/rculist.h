@@ -0,0 +1,174 @@
+/**
+ * @brief Read-mostly concurrent list. Readers traverse without locks, writers serialize
+ * on a mutex and publish changes with release stores.
+ *
+ * @details
+ * Reclamation follows quiescent-state-based RCU. Each reader thread registers once with
+ * `rculist_register`, and periodically announces with `rculist_quiescent` that it holds
+ * no references to list nodes or items, e.g. between two traversals. Unlinked nodes (and
+ * their items, if a free function was given) are freed once every registered reader has
+ * passed a quiescent state or gone offline. Readers that block or idle for a long time
+ * should go offline with `rculist_offline` so they do not hold back reclamation.
+ *
+ * The read-side hot path (`rculist_hasnext` / `rculist_next`) is plain loads with acquire
+ * ordering, which compile to ordinary loads on x86.
+ *
+ * @warning Writer functions may wait for a grace period. A thread must not call them while
+ * its own reader is online, as it would wait for itself. Call `rculist_offline` first.
+ */
+
+#ifndef RCULIST_H
+#define RCULIST_H
+
+#include "defs.h"
+
+#include <stdlib.h>
+
+/* number of removed nodes that are batched before a writer waits for a grace period */
+#define RCULIST_RETIRE_BATCH 64
+
+struct rculist;
+
+/**
+ * Type of concurrent list. `rculist_t` is an alias for `struct rculist`
+ */
+typedef struct rculist rculist_t;
+
+/**
+ * Type of per-thread reader registration. `rculist_reader_t` is an alias for `struct rculist_reader`
+ */
+typedef struct rculist_reader rculist_reader_t;
+
+/**
+ * Type of read-side iterator. `rculist_iter_t` is an alias for `struct rculist_iter`
+ */
+typedef struct rculist_iter rculist_iter_t;
+
+/**
+ * @brief Create a new, empty concurrent list
+ * @param cmpfn: reference to comparison function
+ * @returns A pointer to the newly allocated list, or `NULL` on failure.
+ */
+rculist_t *rculist_create(cmp_fn cmpfn);
+
+/**
+ * @brief Destroy a list, and optionally its items. All readers must be unregistered.
+ * @param list: pointer to list
+ * @param item_free: nullable. If present, called on all items still in the list
+ */
+void rculist_destroy(rculist_t *list, free_fn item_free);
+
+/**
+ * @brief Get the number of items in the list
+ * @param list: pointer to list
+ * @returns Number of items in `list` at some point during the call
+ */
+size_t rculist_length(rculist_t *list);
+
+/**
+ * @brief Add an item to the start of the list (writer)
+ * @param list: pointer to list
+ * @param item: pointer to item to be added
+ * @returns 0 on success, otherwise a negative error code
+ */
+int rculist_addfirst(rculist_t *list, void *item);
+
+/**
+ * @brief Add an item to the end of the list (writer)
+ * @param list: pointer to list
+ * @param item: pointer to item to be added
+ * @returns 0 on success, otherwise a negative error code
+ */
+int rculist_addlast(rculist_t *list, void *item);
+
+/**
+ * @brief Unlink the first occurrence of an item (writer). The node, and the item if
+ * `item_free` is given, are freed after a grace period.
+ * @param list: pointer to list
+ * @param item: pointer to an item that compares as equal, using the list cmpfn
+ * @param item_free: nullable. If present, called on the removed item once no reader can see it
+ * @returns 1 if the item was found and removed, otherwise 0
+ */
+int rculist_remove(rculist_t *list, void *item, free_fn item_free);
+
+/**
+ * @brief Wait for a grace period and free all removed nodes (writer)
+ * @param list: pointer to list
+ */
+void rculist_synchronize(rculist_t *list);
+
+/**
+ * @brief Register the calling thread as a reader. The reader starts online.
+ * @param list: pointer to list
+ * @returns A pointer to the reader registration, or `NULL` on failure.
+ */
+rculist_reader_t *rculist_register(rculist_t *list);
+
+/**
+ * @brief Unregister a reader. The reader must not hold any references.
+ * @param reader: pointer to reader
+ */
+void rculist_unregister(rculist_reader_t *reader);
+
+/**
+ * @brief Announce that the reader holds no references to nodes or items
+ * @param reader: pointer to reader
+ */
+void rculist_quiescent(rculist_reader_t *reader);
+
+/**
+ * @brief Take the reader offline. Grace periods do not wait for offline readers,
+ * and offline readers must not traverse the list.
+ * @param reader: pointer to reader
+ */
+void rculist_offline(rculist_reader_t *reader);
+
+/**
+ * @brief Bring an offline reader back online
+ * @param reader: pointer to reader
+ */
+void rculist_online(rculist_reader_t *reader);
+
+/**
+ * @brief Search for an item in the list (reader)
+ * @param reader: pointer to an online reader
+ * @param item: pointer to an item that compares as equal, using the list cmpfn
+ * @returns 1 if the item was found, otherwise 0
+ */
+int rculist_contains(rculist_reader_t *reader, void *item);
+
+/**
+ * @brief Create an iterator for the given reader. Iterators are meant to be created once
+ * and reused with `rculist_resetiter`.
+ * @param reader: pointer to reader
+ * @returns A pointer to the newly allocated iterator, or `NULL` on failure.
+ */
+rculist_iter_t *rculist_createiter(rculist_reader_t *reader);
+
+/**
+ * @brief Destroy an iterator
+ * @param iter: pointer to iterator
+ */
+void rculist_destroyiter(rculist_iter_t *iter);
+
+/**
+ * @brief Check if the iterator has reached the end of the list
+ * @param iter: pointer to iterator
+ * @returns 0 if iterator is exhausted, otherwise 1
+ */
+int rculist_hasnext(rculist_iter_t *iter);
+
+/**
+ * @brief Get the next item from the list
+ * @param iter: pointer to iterator
+ * @returns A pointer to the next item
+ */
+void *rculist_next(rculist_iter_t *iter);
+
+/**
+ * @brief Reset the iterator to the current first item of the list
+ * @param iter: pointer to iterator
+ */
+void rculist_resetiter(rculist_iter_t *iter);
+
+#endif /* RCULIST_H */
@@ -0,0 +1,168 @@
+/**
+ * @brief Ordered set implemented as a skip list, with an interface in the style of `list.h`.
+ *
+ * @details
+ * Insert, search and delete run in expected O(log n). Items are kept in ascending order
+ * according to the comparison function, and equal items are stored at most once.
+ * Iterators walk the set in both directions, and can be positioned with
+ * `skiplist_lowerbound` / `skiplist_upperbound` for range scans.
+ */
+
+#ifndef SKIPLIST_H
+#define SKIPLIST_H
+
+#include "defs.h"
+
+#include <stdlib.h>
+
+/* maximum tower height. With a level probability of 1/4 this covers 4^16 items */
+#define SKIPLIST_MAXLEVEL 16
+
+struct skiplist;
+
+/**
+ * Type of skip list. `skiplist_t` is an alias for `struct skiplist`
+ */
+typedef struct skiplist skiplist_t;
+
+/**
+ * @brief Create a new, empty skip list ordered by the given comparison function
+ * @param cmpfn: reference to comparison function
+ * @returns A pointer to the newly allocated skip list, or `NULL` on failure.
+ */
+skiplist_t *skiplist_create(cmp_fn cmpfn);
+
+/**
+ * @brief Destroy a skip list, and optionally its items.
+ * @param sl: pointer to skip list
+ * @param item_free: nullable. If present, called on all items
+ */
+void skiplist_destroy(skiplist_t *sl, free_fn item_free);
+
+/**
+ * @brief Get the number of items in the given skip list
+ * @param sl: pointer to skip list
+ * @returns Number of items in `sl`
+ */
+size_t skiplist_length(skiplist_t *sl);
+
+/**
+ * @brief Insert an item in order
+ * @param sl: pointer to skip list
+ * @param item: pointer to item to be added
+ * @returns 0 on success, 1 if an equal item is already present (`item` is not added),
+ * otherwise a negative error code
+ */
+int skiplist_insert(skiplist_t *sl, void *item);
+
+/**
+ * @brief Find the stored item that compares equal to the given item
+ * @param sl: pointer to skip list
+ * @param item: pointer to an item that compares as equal, using the skip list cmpfn
+ * @returns A pointer to the stored item, or `NULL` if not found
+ */
+void *skiplist_get(skiplist_t *sl, void *item);
+
+/**
+ * @brief Search for an item in the given skip list
+ * @param sl: pointer to skip list
+ * @param item: pointer to an item that compares as equal, using the skip list cmpfn
+ * @returns 1 if the item was found, otherwise 0
+ */
+int skiplist_contains(skiplist_t *sl, void *item);
+
+/**
+ * @brief Remove the item that compares equal to the given item
+ * @param sl: pointer to skip list
+ * @param item: pointer to an item that compares as equal, using the skip list cmpfn
+ * @returns A pointer to the removed item, or `NULL` if not found
+ */
+void *skiplist_remove(skiplist_t *sl, void *item);
+
+/**
+ * @brief Get the smallest item
+ * @param sl: pointer to skip list
+ * @returns A pointer to the first item, or `NULL` if the skip list is empty
+ */
+void *skiplist_first(skiplist_t *sl);
+
+/**
+ * @brief Get the largest item
+ * @param sl: pointer to skip list
+ * @returns A pointer to the last item, or `NULL` if the skip list is empty
+ */
+void *skiplist_last(skiplist_t *sl);
+
+/**
+ * Type of skip list iterator. `skiplist_iter_t` is an alias for `struct skiplist_iter`
+ *
+ * The iterator is a cursor that sits between two items. `skiplist_next` returns the item
+ * after the cursor and moves forward, `skiplist_prev` returns the item before the cursor
+ * and moves backward.
+ */
+typedef struct skiplist_iter skiplist_iter_t;
+
+/**
+ * @brief Create an iterator positioned before the first item
+ * @param sl: pointer to skip list
+ * @returns A pointer to the newly allocated iterator, or `NULL` on failure.
+ */
+skiplist_iter_t *skiplist_createiter(skiplist_t *sl);
+
+/**
+ * @brief Create an iterator positioned before the first item that is `>=` the given item
+ * @param sl: pointer to skip list
+ * @param item: pointer to item to compare against
+ * @returns A pointer to the newly allocated iterator, or `NULL` on failure.
+ */
+skiplist_iter_t *skiplist_lowerbound(skiplist_t *sl, void *item);
+
+/**
+ * @brief Create an iterator positioned before the first item that is `>` the given item
+ * @param sl: pointer to skip list
+ * @param item: pointer to item to compare against
+ * @returns A pointer to the newly allocated iterator, or `NULL` on failure.
+ */
+skiplist_iter_t *skiplist_upperbound(skiplist_t *sl, void *item);
+
+/**
+ * @brief Destroy a skip list iterator. Does not free the underlying skip list
+ * @param iter: pointer to iterator
+ */
+void skiplist_destroyiter(skiplist_iter_t *iter);
+
+/**
+ * @brief Check if there is an item after the cursor
+ * @param iter: pointer to iterator
+ * @returns 0 if iterator is exhausted, otherwise 1
+ */
+int skiplist_hasnext(skiplist_iter_t *iter);
+
+/**
+ * @brief Get the item after the cursor and move forward
+ * @param iter: pointer to iterator
+ * @returns A pointer to the next item, or `NULL` if the iterator is exhausted
+ */
+void *skiplist_next(skiplist_iter_t *iter);
+
+/**
+ * @brief Check if there is an item before the cursor
+ * @param iter: pointer to iterator
+ * @returns 0 if the cursor is at the start, otherwise 1
+ */
+int skiplist_hasprev(skiplist_iter_t *iter);
+
+/**
+ * @brief Get the item before the cursor and move backward
+ * @param iter: pointer to iterator
+ * @returns A pointer to the previous item, or `NULL` if the cursor is at the start
+ */
+void *skiplist_prev(skiplist_iter_t *iter);
+
+/**
+ * @brief Reset the given iterator to before the first item
+ * @param iter: pointer to iterator
+ */
+void skiplist_resetiter(skiplist_iter_t *iter);
+
+#endif /* SKIPLIST_H */
@@ -1,6 +1,22 @@
 #ifndef TEST_H
 #define TEST_H
 
+/**
+ * @brief Run a test, and report its hardware counters (see `perf.h`), or only its time if no
+ * counters are available
+ * @param name: label printed with the result
+ * @param test: test function
+ */
+void test_run(const char *name, void (*test)());
+
+/**
+ * @brief Close the counter group shared by all test runs. Call once all tests have run
+ */
+void test_teardown();
+
+/* runs a test function, labelled with its name */
+#define RUN_TEST(test) test_run(#test, test)
+
 void test_intcmp();
 
 void test_create_destroy();
@@ -27,4 +43,70 @@ void test_next();
 
 void test_resetiter();
 
+void test_extsort_inmemory();
+
+void test_extsort_spill();
+
+void test_extsort_empty();
+
+void test_extsort_corrupt();
+
+void test_skiplist_insert_contains();
+
+void test_skiplist_remove();
+
+void test_skiplist_iter();
+
+void test_rculist_basic();
+
+void test_rculist_concurrent();
+
+void test_arena();
+
+void test_list_allocator();
+
+void test_string_allocator();
+
+void test_vec_basic();
+
+void test_pdqsort();
+
+void test_vec_sort_bsearch();
+
+void test_vec_typed();
+
+void test_deque_ends();
+
+void test_deque_queue();
+
+void test_pqueue_order();
+
+void test_pqueue_heapify();
+
+void test_pqueue_decreasekey();
+
+void test_bloom_basic();
+
+void test_list_filter();
+
+void test_trace();
+
+void test_threadpool_fib();
+
+void test_list_parallel();
+
+void test_ilist_basic();
+
+void test_ilist_sort_compact();
+
+void test_pvec_basic();
+
+void test_pvec_snapshot();
+
+void test_ebr_basic();
+
+void test_ebr_threads();
+
+void test_perf();
+
 #endif // !TEST_H
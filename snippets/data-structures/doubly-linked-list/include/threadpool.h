@@ -0,0 +1,106 @@
+/**
+ * @brief Fork-join thread pool with work stealing.
+ *
+ * @details
+ * Every thread of the pool owns a Chase–Lev deque of tasks. A task spawns subtasks onto the
+ * bottom of its own thread's deque and later joins them; idle threads steal from the top of
+ * other deques, so large pieces of work move between threads and small ones stay local.
+ *
+ * The thread calling `threadpool_run` takes part as one of the pool's threads until the root
+ * task returns. A pool of `n` threads therefore starts `n - 1` worker threads.
+ *
+ * ```
+ * static void fib(void *arg) {
+ *     struct fibarg *f = arg;
+ *     ...
+ *     threadpool_task_t left = THREADPOOL_TASK(fib, &leftarg);
+ *     threadpool_spawn(f->pool, &left);
+ *     fib(&rightarg);
+ *     threadpool_join(f->pool, &left);
+ *     ...
+ * }
+ * threadpool_run(pool, fib, &arg);
+ * ```
+ *
+ * Passing a `NULL` pool to any function runs the tasks on the calling thread.
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+struct threadpool;
+
+/**
+ * Type of thread pool. `threadpool_t` is an alias for `struct threadpool`
+ */
+typedef struct threadpool threadpool_t;
+
+/**
+ * @brief Type of task function
+ */
+typedef void (*task_fn)(void *arg);
+
+/**
+ * Type of task. Tasks are owned by the spawner, usually on its stack, and must stay alive
+ * until joined. `threadpool_task_t` is an alias for `struct threadpool_task`
+ */
+typedef struct threadpool_task {
+  task_fn fn;
+  void *arg;
+  atomic_int done;
+} threadpool_task_t;
+
+/* initializer for a task that runs `fn(arg)` */
+#define THREADPOOL_TASK(fn, arg) ((threadpool_task_t) {(fn), (arg), 0})
+
+/**
+ * @brief Create a new thread pool
+ * @param nthreads: number of threads taking part in a run, including the caller of
+ * `threadpool_run`. If 0, the number of online CPUs
+ * @returns A pointer to the newly allocated pool, or `NULL` on failure.
+ */
+threadpool_t *threadpool_create(size_t nthreads);
+
+/**
+ * @brief Stop the worker threads and destroy the pool
+ * @param pool: pointer to pool
+ * @warning must not be called during a run
+ */
+void threadpool_destroy(threadpool_t *pool);
+
+/**
+ * @brief Get the number of threads taking part in a run of the given pool
+ * @param pool: nullable. Pointer to pool
+ * @returns Number of threads, including the caller. 1 if `pool` is `NULL`
+ */
+size_t threadpool_nthreads(threadpool_t *pool);
+
+/**
+ * @brief Run `fn(arg)` as the root task on the pool, and wait for it to return
+ * @param pool: nullable. Pointer to pool
+ * @param fn: root task, which may spawn and join subtasks
+ * @param arg: argument passed to `fn`
+ * @note Runs from different threads are serialized. Called from within a task of the same
+ * pool, `fn` simply runs as part of that task.
+ */
+void threadpool_run(threadpool_t *pool, task_fn fn, void *arg);
+
+/**
+ * @brief Make a task available to other threads of the pool. Call from within a run
+ * @param pool: nullable. Pointer to pool
+ * @param task: pointer to task, initialized with `THREADPOOL_TASK`
+ * @note Outside a run of `pool` (or if `pool` is `NULL`), the task runs immediately instead.
+ */
+void threadpool_spawn(threadpool_t *pool, threadpool_task_t *task);
+
+/**
+ * @brief Wait until a spawned task is done, running other tasks in the meantime
+ * @param pool: nullable. Pointer to pool
+ * @param task: pointer to a task passed to `threadpool_spawn` by the calling thread
+ */
+void threadpool_join(threadpool_t *pool, threadpool_task_t *task);
+
+#endif /* THREADPOOL_H */
@@ -0,0 +1,102 @@
+/**
+ * @brief Defines macros for timed trace spans, exported in the Chrome trace-event format.
+ *
+ * @details
+ * Defines the following macros:
+ * - TRACE_BEGIN(name)
+ * - TRACE_END()
+ * - TRACE_SCOPE(name)
+ * - TRACE_EXPORT(path)
+ *
+ * Spans record a timestamp (the TSC on x86-64) and the thread id into a buffer owned by the
+ * calling thread, so recording takes no locks. `TRACE_EXPORT` writes the spans of all threads
+ * as JSON that chrome://tracing and https://ui.perfetto.dev can open.
+ *
+ * ```
+ * void list_sort(list_t *list) {
+ *     TRACE_SCOPE("list_sort");
+ *     ...
+ * }
+ * ```
+ *
+ * @note
+ * Unless TRACING is defined, the macros do nothing and their invocations are removed by the
+ * preprocessor, and `TRACE_EXPORT` evaluates to 0. Span names must be string literals, or
+ * otherwise outlive the export.
+ */
+
+#ifndef TRACE_H
+#  define TRACE_H
+
+/*************/
+/** OPTIONS **/
+/*************/
+
+/* define to enable tracing */
+// #define TRACING
+
+/* events per buffer chunk. Threads add chunks as needed */
+#  define TRACE_CHUNKSIZE 4096
+
+/********************/
+/** END OF OPTIONS **/
+/********************/
+
+#  ifdef TRACING
+
+/* the span of a TRACE_SCOPE ends when the enclosing scope is left */
+#    define TRACE_SCOPE(name) TRACE_SCOPE_(name, __LINE__)
+#    define TRACE_SCOPE_(name, line) TRACE_SCOPE__(name, line)
+#    define TRACE_SCOPE__(name, line) \
+          __attribute__((cleanup(trace_endscope), unused)) int trace_scope_##line = trace_beginscope(name)
+
+#    define TRACE_BEGIN(name)  trace_begin(name)
+#    define TRACE_END()        trace_end()
+#    define TRACE_EXPORT(path) trace_export(path)
+
+/**
+ * @brief Start a span on the calling thread. Use `TRACE_BEGIN` instead
+ * @param name: name of the span
+ */
+void trace_begin(const char *name);
+
+/**
+ * @brief End the most recent open span on the calling thread. Use `TRACE_END` instead
+ */
+void trace_end(void);
+
+/**
+ * @brief Write the spans recorded so far by all threads to a file, in the Chrome trace-event
+ * JSON format. Use `TRACE_EXPORT` instead
+ * @param path: path of the file to write
+ * @returns 0 on success, otherwise a negative error code
+ * @warning no other thread may record spans during the export
+ */
+int trace_export(const char *path);
+
+/**
+ * @brief Discard all spans recorded so far
+ * @warning no other thread may record spans during the reset
+ */
+void trace_reset(void);
+
+static inline int trace_beginscope(const char *name) {
+    trace_begin(name);
+    return 0;
+}
+
+static inline void trace_endscope(int *scope) {
+    (void) scope;
+    trace_end();
+}
+
+#  else
+
+#    define TRACE_SCOPE(name)  ((void) 0)
+#    define TRACE_BEGIN(name)  ((void) 0)
+#    define TRACE_END()        ((void) 0)
+#    define TRACE_EXPORT(path) (0)
+
+#  endif /* TRACING */
+
+#endif /* TRACE_H */
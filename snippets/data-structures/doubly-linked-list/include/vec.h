@@ -0,0 +1,230 @@
+/**
+ * @brief Contiguous growable array of item pointers, with an interface in the style of `list.h`.
+ *
+ * @details
+ * Items are stored back to back, so iteration, sorting and linear search touch far fewer
+ * cache lines than the same operations on a `list_t`. Adding and removing at the end are
+ * amortized O(1). `vec_sort` uses pattern-defeating quicksort, and `vec_bsearch` finds
+ * items in a sorted vec in O(log n).
+ *
+ * `VEC_DEFINE` generates a typed variant that stores values of any type inline.
+ */
+
+#ifndef VEC_H
+#define VEC_H
+
+#include "defs.h"
+#include "pdqsort.h"
+#include "printing.h"
+
+#include <stdlib.h>
+
+struct vec;
+
+/**
+ * Type of vec. `vec_t` is an alias for `struct vec`
+ */
+typedef struct vec vec_t;
+
+/**
+ * @brief Create a new, empty vec that uses the given comparison function
+ * @param cmpfn: reference to comparison function
+ * @returns A pointer to the newly allocated vec, or `NULL` on failure.
+ */
+vec_t *vec_create(cmp_fn cmpfn);
+
+/**
+ * @brief Create a new, empty vec that allocates its storage with the given allocator
+ * @param cmpfn: reference to comparison function
+ * @param allocator: nullable. The struct is copied. If `NULL`, malloc/free are used
+ * @returns A pointer to the newly allocated vec, or `NULL` on failure.
+ */
+vec_t *vec_create_with_allocator(cmp_fn cmpfn, const allocator_t *allocator);
+
+/**
+ * @brief Destroy a vec, and optionally its items.
+ * @param vec: pointer to vec
+ * @param item_free: nullable. If present, called on all items
+ */
+void vec_destroy(vec_t *vec, free_fn item_free);
+
+/**
+ * @brief Get the number of items in a given vec
+ * @param vec: pointer to vec
+ * @returns Number of items in `vec`
+ */
+size_t vec_length(vec_t *vec);
+
+/**
+ * @brief Get the memory used by a vec itself, not its items
+ * @param vec: pointer to vec
+ * @param stat: set to the bytes currently in use, and the peak over the lifetime of the vec
+ */
+void vec_memstat(vec_t *vec, memstat_t *stat);
+
+/**
+ * @brief Make room for at least `capacity` items without further reallocation
+ * @param vec: pointer to vec
+ * @param capacity: number of items
+ * @returns 0 on success, otherwise a negative error code
+ */
+int vec_reserve(vec_t *vec, size_t capacity);
+
+/**
+ * @brief Add an item to the end of the given vec
+ * @param vec: pointer to vec
+ * @param item: pointer to item to be added
+ * @returns 0 on success, otherwise a negative error code
+ */
+int vec_addlast(vec_t *vec, void *item);
+
+/**
+ * @brief Remove the last item from the given vec
+ * @param vec: pointer to vec
+ * @returns A pointer to the removed item
+ * @warning panics if vec is empty
+ */
+void *vec_poplast(vec_t *vec);
+
+/**
+ * @brief Get the item at the given index
+ * @param vec: pointer to vec
+ * @param index: index of item, where 0 is the first
+ * @returns A pointer to the item, or `NULL` if `index` is out of bounds
+ */
+void *vec_get(vec_t *vec, size_t index);
+
+/**
+ * @brief Get direct access to the items, e.g. for iteration. Valid until the vec is modified.
+ * @param vec: pointer to vec
+ * @returns A pointer to the first of `vec_length(vec)` item pointers
+ */
+void **vec_items(vec_t *vec);
+
+/**
+ * @brief Removes the first occurrence of an item, shifting later items down
+ * @param vec: pointer to vec
+ * @param item: pointer to an item that compares as equal, using the vec cmpfn
+ * @returns A pointer to the removed item, or `NULL` if not found
+ */
+void *vec_remove(vec_t *vec, void *item);
+
+/**
+ * @brief Search for an item in the given vec
+ * @param vec: pointer to vec
+ * @param item: pointer to an item that compares as equal, using the vec cmpfn
+ * @returns 1 if the item was found, otherwise 0
+ */
+int vec_contains(vec_t *vec, void *item);
+
+/**
+ * @brief Sorts the items of the given vec in ascending order with pattern-defeating quicksort
+ * @param vec: pointer to vec
+ * @note The sort is not stable
+ */
+void vec_sort(vec_t *vec);
+
+/**
+ * @brief Binary search for an item in a sorted vec
+ * @param vec: pointer to a vec sorted with `vec_sort`
+ * @param item: pointer to an item that compares as equal, using the vec cmpfn
+ * @param index: nullable. Set to the index of the first equal item if found, otherwise to
+ * the index where the item would be inserted to keep the vec sorted
+ * @returns 1 if the item was found, otherwise 0
+ */
+int vec_bsearch(vec_t *vec, void *item, size_t *index);
+
+
+/* ---- typed variant ---- */
+
+
+/**
+ * @brief Define a typed vec named `name` holding values of `type` inline.
+ *
+ * @details
+ * Generates `name_t` and the inline functions `name_init`, `name_free`, `name_reserve`,
+ * `name_addlast`, `name_poplast`, `name_get`, `name_contains`, `name_sort` and `name_bsearch`.
+ * Comparison functions take pointers to two values. A zeroed `name_t` is a valid empty vec.
+ *
+ * ```
+ * VEC_DEFINE(intvec, int)
+ * intvec_t v;
+ * intvec_init(&v);
+ * intvec_addlast(&v, 42);
+ * ```
+ */
+#define VEC_DEFINE(name, type)                                                            \
+  typedef struct name {                                                                   \
+    type *data;                                                                           \
+    size_t length;                                                                        \
+    size_t capacity;                                                                      \
+  } name##_t;                                                                             \
+                                                                                          \
+  static inline void name##_init(name##_t *v) {                                           \
+    v->data = NULL;                                                                       \
+    v->length = 0;                                                                        \
+    v->capacity = 0;                                                                      \
+  }                                                                                       \
+                                                                                          \
+  static inline void name##_free(name##_t *v) {                                           \
+    free(v->data);                                                                        \
+    name##_init(v);                                                                       \
+  }                                                                                       \
+                                                                                          \
+  static inline int name##_reserve(name##_t *v, size_t capacity) {                        \
+    if (capacity <= v->capacity) return 0;                                                \
+    type *data = realloc(v->data, capacity * sizeof(type));                               \
+    if (NULL == data) return -1;                                                          \
+    v->data = data;                                                                       \
+    v->capacity = capacity;                                                               \
+    return 0;                                                                             \
+  }                                                                                       \
+                                                                                          \
+  static inline int name##_addlast(name##_t *v, type value) {                             \
+    if (v->length == v->capacity &&                                                       \
+        name##_reserve(v, v->capacity ? 2 * v->capacity : 8) < 0) {                       \
+      return -1;                                                                          \
+    }                                                                                     \
+    v->data[v->length++] = value;                                                         \
+    return 0;                                                                             \
+  }                                                                                       \
+                                                                                          \
+  /* the vec must not be empty */                                                         \
+  static inline type name##_poplast(name##_t *v) {                                        \
+    if (0 == v->length) PANIC("Vec is empty, PANICING(exiting)\n");                       \
+    return v->data[--v->length];                                                          \
+  }                                                                                       \
+                                                                                          \
+  static inline type *name##_get(name##_t *v, size_t index) {                             \
+    return index < v->length ? &v->data[index] : NULL;                                    \
+  }                                                                                       \
+                                                                                          \
+  static inline int name##_contains(name##_t *v, const type *value,                       \
+                                    int (*cmp)(const type *, const type *)) {             \
+    for (size_t i = 0; i < v->length; i++) {                                              \
+      if (cmp(&v->data[i], value) == 0) return 1;                                         \
+    }                                                                                     \
+    return 0;                                                                             \
+  }                                                                                       \
+                                                                                          \
+  static inline void name##_sort(name##_t *v, int (*cmp)(const type *, const type *)) {   \
+    pdqsort(v->data, v->length, sizeof(type), (cmp_fn) cmp);                              \
+  }                                                                                       \
+                                                                                          \
+  static inline int name##_bsearch(name##_t *v, const type *value,                        \
+                                   int (*cmp)(const type *, const type *),                \
+                                   size_t *index) {                                       \
+    size_t lo = 0, hi = v->length;                                                        \
+    while (lo < hi) {                                                                     \
+      size_t mid = lo + (hi - lo) / 2;                                                    \
+      if (cmp(&v->data[mid], value) < 0) {                                                \
+        lo = mid + 1;                                                                     \
+      } else {                                                                            \
+        hi = mid;                                                                         \
+      }                                                                                   \
+    }                                                                                     \
+    if (NULL != index) *index = lo;                                                       \
+    return lo < v->length && cmp(&v->data[lo], value) == 0;                               \
+  }
+
+#endif /* VEC_H */
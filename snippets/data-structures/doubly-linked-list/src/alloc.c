@@ -0,0 +1,180 @@
+#include "alloc.h"
+#include "defs.h"
+#include "printing.h"
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ALIGN       alignof(max_align_t)
+#define ALIGNUP(sz) (((sz) + ALIGN - 1) & ~(ALIGN - 1))
+
+
+/* ---- stdlib ---- */
+
+
+static void *stdlib_alloc(void *ctx, size_t size) {
+  (void) ctx;
+  return malloc(size);
+}
+
+static void *stdlib_realloc(void *ctx, void *ptr, size_t oldsize, size_t newsize) {
+  (void) ctx;
+  (void) oldsize;
+  return realloc(ptr, newsize);
+}
+
+static void stdlib_free(void *ctx, void *ptr, size_t size) {
+  (void) ctx;
+  (void) size;
+  free(ptr);
+}
+
+const allocator_t stdlib_allocator = {stdlib_alloc, stdlib_realloc, stdlib_free, NULL};
+
+
+/* ---- arena ---- */
+
+
+typedef struct block block_t;
+struct block {
+  block_t *next;
+  size_t size;
+  size_t used;
+  alignas(max_align_t) unsigned char data[];
+};
+
+struct arena {
+  block_t *head;     /* block currently allocated from */
+  size_t blocksize;
+  void *last;        /* most recent allocation, which can be grown or rolled back in place */
+  memstat_t stat;
+};
+
+
+static block_t *newblock(size_t size) {
+  block_t *block = malloc(sizeof *block + size);
+  if (NULL == block) {
+    pr_error("Failed to allocate arena block\n");
+    return NULL;
+  }
+
+  block->next = NULL;
+  block->size = size;
+  block->used = 0;
+
+  return block;
+}
+
+arena_t *arena_create(size_t blocksize) {
+  arena_t *arena = malloc(sizeof *arena);
+  if (NULL == arena) {
+    pr_error("Failed to allocate memory for arena\n");
+    return NULL;
+  }
+
+  arena->blocksize = ALIGNUP(blocksize ? blocksize : ARENA_BLOCKSIZE);
+  arena->head = newblock(arena->blocksize);
+  if (NULL == arena->head) {
+    free(arena);
+    return NULL;
+  }
+  arena->last = NULL;
+  arena->stat.inuse = 0;
+  arena->stat.peak = 0;
+
+  return arena;
+}
+
+void arena_destroy(arena_t *arena) {
+  if (NULL == arena) return;
+
+  block_t *block = arena->head;
+  while (NULL != block) {
+    block_t *next = block->next;
+    free(block);
+    block = next;
+  }
+
+  free(arena);
+}
+
+void arena_reset(arena_t *arena) {
+  block_t *block = arena->head->next;
+  while (NULL != block) {
+    block_t *next = block->next;
+    free(block);
+    block = next;
+  }
+
+  arena->head->next = NULL;
+  arena->head->used = 0;
+  arena->last = NULL;
+  arena->stat.inuse = 0;
+}
+
+void arena_memstat(arena_t *arena, memstat_t *stat) { *stat = arena->stat; }
+
+static void *arena_alloc(void *ctx, size_t size) {
+  arena_t *arena = ctx;
+  size_t need = ALIGNUP(size ? size : 1);
+
+  block_t *block = arena->head;
+  if (block->size - block->used < need) {
+    block = newblock(need > arena->blocksize ? need : arena->blocksize);
+    if (NULL == block) return NULL;
+    block->next = arena->head;
+    arena->head = block;
+  }
+
+  void *ptr = block->data + block->used;
+  block->used += need;
+  arena->last = ptr;
+
+  arena->stat.inuse += need;
+  if (arena->stat.inuse > arena->stat.peak) arena->stat.peak = arena->stat.inuse;
+
+  return ptr;
+}
+
+static void *arena_realloc(void *ctx, void *ptr, size_t oldsize, size_t newsize) {
+  arena_t *arena = ctx;
+  if (NULL == ptr) return arena_alloc(ctx, newsize);
+
+  /* the most recent allocation can be resized in place if the block has room */
+  block_t *block = arena->head;
+  if (ptr == arena->last) {
+    size_t start = (unsigned char *) ptr - block->data;
+    size_t need = ALIGNUP(newsize ? newsize : 1);
+    if (block->size - start >= need) {
+      size_t old = block->used - start;
+      block->used = start + need;
+      arena->stat.inuse = arena->stat.inuse - old + need;
+      if (arena->stat.inuse > arena->stat.peak) arena->stat.peak = arena->stat.inuse;
+      return ptr;
+    }
+  }
+
+  void *newptr = arena_alloc(ctx, newsize);
+  if (NULL != newptr) memcpy(newptr, ptr, oldsize < newsize ? oldsize : newsize);
+
+  return newptr;
+}
+
+static void arena_free(void *ctx, void *ptr, size_t size) {
+  arena_t *arena = ctx;
+
+  /* roll back the most recent allocation, everything else is released on reset */
+  if (NULL != ptr && ptr == arena->last) {
+    size_t need = ALIGNUP(size ? size : 1);
+    arena->head->used -= need;
+    arena->stat.inuse -= need;
+    arena->last = NULL;
+  }
+}
+
+allocator_t arena_allocator(arena_t *arena) {
+  allocator_t allocator = {arena_alloc, arena_realloc, arena_free, arena};
+  return allocator;
+}
@@ -0,0 +1,61 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <time.h>
+
+
+double bench_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+/* one counter group for all regions, opened by the first */
+static perf_t *perf;
+
+void bench_begin(bench_t *b, const char *name) {
+  if (NULL == perf) perf = perf_create();
+
+  b->name = name;
+  b->elapsed = 0.0;
+  b->start = bench_now();
+  if (NULL != perf) perf_start(perf);
+}
+
+double bench_end(bench_t *b, size_t nelems) {
+  char counters[128] = "";
+
+  if (NULL != perf) {
+    perf_stop(perf, &b->sample);
+    b->elapsed = b->sample.seconds;
+    perf_format(&b->sample, nelems, counters, sizeof counters);
+  } else {
+    b->elapsed = bench_now() - b->start;
+  }
+
+  if (0 == nelems) {
+    printf("  %-44s %10.3f ms%s%s\n", b->name, b->elapsed * 1e3, *counters ? "                 " : "",
+           counters);
+  } else {
+    printf("  %-44s %10.3f ms %10.2f ns/elem%s%s\n", b->name, b->elapsed * 1e3,
+           b->elapsed * 1e9 / (double) nelems, *counters ? "  " : "", counters);
+  }
+
+  return b->elapsed;
+}
+
+void bench_teardown(void) {
+  perf_destroy(perf);
+  perf = NULL;
+}
+
+void bench_section(const char *title) { printf("\n== %s ==\n", title); }
+
+uint64_t bench_rand(uint64_t *state) {
+  uint64_t x = *state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  *state = x;
+  return x * 0x2545F4914F6CDD1DULL;
+}
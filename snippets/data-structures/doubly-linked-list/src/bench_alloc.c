@@ -0,0 +1,40 @@
+#include "alloc.h"
+#include "bench.h"
+#include "list.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NITEMS  1000000
+#define ROUNDS  5
+
+static int intcmp(const int *a, const int *b) { return *a - *b; }
+
+static void run(const char *name, const allocator_t *allocator, arena_t *arena) {
+  static int item;
+  bench_t b;
+  memstat_t stat;
+
+  bench_begin(&b, name);
+  for (int round = 0; round < ROUNDS; round++) {
+    list_t *list = list_create_with_allocator((cmp_fn) intcmp, allocator);
+    for (size_t i = 0; i < NITEMS; i++) {
+      list_addlast(list, &item);
+    }
+    list_memstat(list, &stat);
+    list_destroy(list, NULL);
+    if (arena) arena_reset(arena);
+  }
+  bench_end(&b, (size_t) ROUNDS * NITEMS);
+  printf("  %-44s %10.1f bytes/elem peak\n", "", (double) stat.peak / NITEMS);
+}
+
+void bench_alloc(void) {
+  bench_section("list_addlast + list_destroy, 1M items");
+  run("stdlib allocator", NULL, NULL);
+
+  arena_t *arena = arena_create(1024 * 1024);
+  allocator_t a = arena_allocator(arena);
+  run("arena allocator (reset per round)", &a, arena);
+  arena_destroy(arena);
+}
@@ -0,0 +1,100 @@
+#include "bench.h"
+#include "bloom.h"
+#include "list.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NITEMS   4096
+#define LOOKUPS  20000
+#define NFILTER  1000000
+
+static int u64cmp(const uint64_t *a, const uint64_t *b) { return (*a > *b) - (*a < *b); }
+
+static uint64_t u64hash(const uint64_t *a) { return *a; }
+
+/* keys [0, NITEMS) are in the list, so a key drawn from [0, NITEMS / ratio) hits with `ratio` */
+static void lookups(list_t *list, uint64_t *probes, double ratio, uint64_t *seed) {
+  uint64_t range = (uint64_t) (NITEMS / ratio);
+  for (size_t i = 0; i < LOOKUPS; i++) {
+    probes[i] = bench_rand(seed) % range;
+  }
+
+  char name[64];
+  bench_t b;
+  size_t found = 0;
+
+  snprintf(name, sizeof name, "list_contains, %2.0f%% hits", ratio * 100);
+  bench_begin(&b, name);
+  for (size_t i = 0; i < LOOKUPS; i++) {
+    found += list_contains(list, &probes[i]);
+  }
+  bench_end(&b, LOOKUPS);
+
+  list_setfilter(list, (hash64_fn) u64hash, 0.01);
+  snprintf(name, sizeof name, "list_contains + filter, %2.0f%% hits", ratio * 100);
+  bench_begin(&b, name);
+  for (size_t i = 0; i < LOOKUPS; i++) {
+    found -= list_contains(list, &probes[i]);
+  }
+  bench_end(&b, LOOKUPS);
+  list_setfilter(list, NULL, 0);
+
+  if (found != 0) printf("filter changed the result of list_contains\n");
+}
+
+void bench_bloom(void) {
+  uint64_t seed = 0xB100F;
+  uint64_t *keys = malloc(NFILTER * sizeof *keys);
+  uint64_t *probes = malloc(LOOKUPS * sizeof *probes);
+  for (size_t i = 0; i < NFILTER; i++) {
+    keys[i] = i;
+  }
+
+  bench_section("list_contains with and without a 1% Bloom filter (4096 items)");
+
+  list_t *list = list_create((cmp_fn) u64cmp);
+  for (size_t i = 0; i < NITEMS; i++) {
+    list_addlast(list, &keys[i]);
+  }
+  lookups(list, probes, 0.01, &seed);
+  lookups(list, probes, 0.10, &seed);
+  lookups(list, probes, 0.50, &seed);
+  list_destroy(list, NULL);
+
+  bench_section("blocked Bloom filter (1M items)");
+
+  const double rates[] = {0.01, 0.001};
+  for (size_t r = 0; r < sizeof rates / sizeof *rates; r++) {
+    bloom_t *bf = bloom_create((hash64_fn) u64hash, NFILTER, rates[r]);
+    bench_t b;
+    char name[64];
+
+    snprintf(name, sizeof name, "bloom_add (fp rate %g)", rates[r]);
+    bench_begin(&b, name);
+    for (size_t i = 0; i < NFILTER; i++) {
+      bloom_add(bf, &keys[i]);
+    }
+    bench_end(&b, NFILTER);
+
+    /* probe keys that were never added, to measure the false-positive rate */
+    size_t positives = 0;
+    snprintf(name, sizeof name, "bloom_maycontain, misses (fp rate %g)", rates[r]);
+    bench_begin(&b, name);
+    for (size_t i = 0; i < NFILTER; i++) {
+      uint64_t key = NFILTER + i;
+      positives += bloom_maycontain(bf, &key);
+    }
+    bench_end(&b, NFILTER);
+
+    bloom_stats_t stats;
+    bloom_stats(bf, &stats);
+    printf("  %zu blocks, %zu hashes, %.1f%% of bits set, measured fp rate %.4f\n",
+           stats.nblocks, stats.nhashes, stats.fill * 100, (double) positives / NFILTER);
+    bloom_destroy(bf);
+  }
+
+  free(probes);
+  free(keys);
+}
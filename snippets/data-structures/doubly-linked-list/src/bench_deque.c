@@ -0,0 +1,63 @@
+#include "bench.h"
+#include "deque.h"
+#include "list.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define QUEUELEN 1000
+#define NOPS     10000000
+
+static int intcmp(const int *a, const int *b) { return *a - *b; }
+
+void bench_deque(void) {
+  static int items[QUEUELEN];
+  bench_t b;
+  uint64_t seed = 1;
+  long sum = 0;
+
+  list_t *list = list_create((cmp_fn) intcmp);
+  deque_t *dq = deque_create((cmp_fn) intcmp);
+  for (int i = 0; i < QUEUELEN; i++) {
+    items[i] = i;
+    list_addlast(list, &items[i]);
+    deque_addlast(dq, &items[i]);
+  }
+
+  bench_section("deque vs list_t, steady-state queue of 1000 items");
+
+  bench_begin(&b, "list_t: list_addlast + list_popfirst");
+  for (size_t i = 0; i < NOPS; i++) {
+    list_addlast(list, list_popfirst(list));
+  }
+  bench_end(&b, NOPS);
+
+  bench_begin(&b, "deque: deque_addlast + deque_popfirst");
+  for (size_t i = 0; i < NOPS; i++) {
+    deque_addlast(dq, deque_popfirst(dq));
+  }
+  bench_end(&b, NOPS);
+
+  bench_begin(&b, "list_t: list_addfirst + list_poplast");
+  for (size_t i = 0; i < NOPS; i++) {
+    list_addfirst(list, list_poplast(list));
+  }
+  bench_end(&b, NOPS);
+
+  bench_begin(&b, "deque: deque_addfirst + deque_poplast");
+  for (size_t i = 0; i < NOPS; i++) {
+    deque_addfirst(dq, deque_poplast(dq));
+  }
+  bench_end(&b, NOPS);
+
+  bench_begin(&b, "deque: deque_get (random index)");
+  for (size_t i = 0; i < NOPS; i++) {
+    sum += *(int *) deque_get(dq, bench_rand(&seed) % QUEUELEN);
+  }
+  bench_end(&b, NOPS);
+
+  if (sum == 42) printf("\n");
+  list_destroy(list, NULL);
+  deque_destroy(dq, NULL);
+}
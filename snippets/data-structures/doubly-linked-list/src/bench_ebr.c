@@ -0,0 +1,159 @@
+#include "bench.h"
+#include "ebr.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define NOPS   10000000
+#define NSWAPS 200000
+
+typedef struct node {
+  long value;
+} node_t;
+
+typedef struct shared {
+  ebr_t *ebr;
+  node_t *_Atomic slot;
+  int hazards;
+} shared_t;
+
+typedef struct worker {
+  pthread_t thread;
+  shared_t *sh;
+  long sum;
+  size_t maxpending;
+} worker_t;
+
+static void read_overhead(void) {
+  ebr_t *ebr = ebr_create();
+  ebr_thread_t *thr = ebr_register(ebr);
+  node_t node = {1};
+  node_t *_Atomic slot = &node;
+  pthread_rwlock_t rwlock;
+  pthread_rwlock_init(&rwlock, NULL);
+  bench_t b;
+  long sum = 0;
+
+  bench_section("ebr read-side overhead (1 thread)");
+
+  bench_begin(&b, "ebr_enter + load + ebr_exit");
+  for (size_t i = 0; i < NOPS; i++) {
+    ebr_enter(thr);
+    sum += atomic_load_explicit(&slot, memory_order_acquire)->value;
+    ebr_exit(thr);
+  }
+  bench_end(&b, NOPS);
+
+  ebr_enter(thr);
+  bench_begin(&b, "nested ebr_enter + load + ebr_exit");
+  for (size_t i = 0; i < NOPS; i++) {
+    ebr_enter(thr);
+    sum += atomic_load_explicit(&slot, memory_order_acquire)->value;
+    ebr_exit(thr);
+  }
+  bench_end(&b, NOPS);
+  ebr_exit(thr);
+
+  bench_begin(&b, "ebr_protect + validate + ebr_unprotect");
+  for (size_t i = 0; i < NOPS; i++) {
+    node_t *n;
+    do {
+      n = atomic_load(&slot);
+      ebr_protect(thr, 0, n);
+    } while (n != atomic_load(&slot));
+    sum += n->value;
+    ebr_unprotect(thr, 0);
+  }
+  bench_end(&b, NOPS);
+
+  bench_begin(&b, "pthread_rwlock_rdlock + load + unlock");
+  for (size_t i = 0; i < NOPS; i++) {
+    pthread_rwlock_rdlock(&rwlock);
+    sum += atomic_load_explicit(&slot, memory_order_acquire)->value;
+    pthread_rwlock_unlock(&rwlock);
+  }
+  bench_end(&b, NOPS);
+
+  if (sum == 42) printf("\n");
+  pthread_rwlock_destroy(&rwlock);
+  ebr_unregister(thr);
+  ebr_destroy(ebr);
+}
+
+/* every thread reads the shared node, then replaces it and retires the old one */
+static void *swapper(void *arg) {
+  worker_t *w = arg;
+  shared_t *sh = w->sh;
+  ebr_thread_t *thr = ebr_register(sh->ebr);
+
+  for (long i = 0; i < NSWAPS; i++) {
+    node_t *node;
+    if (sh->hazards) {
+      do {
+        node = atomic_load(&sh->slot);
+        ebr_protect(thr, 0, node);
+      } while (node != atomic_load(&sh->slot));
+      w->sum += node->value;
+      ebr_unprotect(thr, 0);
+    } else {
+      ebr_enter(thr);
+      w->sum += atomic_load_explicit(&sh->slot, memory_order_acquire)->value;
+      ebr_exit(thr);
+    }
+
+    node_t *fresh = malloc(sizeof *fresh);
+    fresh->value = i;
+    ebr_retire(thr, atomic_exchange(&sh->slot, fresh), free);
+
+    if (0 == i % EBR_RETIRE_BATCH) {
+      size_t pending = ebr_collect(thr);
+      if (pending > w->maxpending) w->maxpending = pending;
+    }
+  }
+
+  ebr_unregister(thr);
+  return NULL;
+}
+
+static void run(int hazards, int nthreads) {
+  shared_t sh = {ebr_create(), malloc(sizeof(node_t)), hazards};
+  atomic_load(&sh.slot)->value = 0;
+  worker_t *workers = calloc(nthreads, sizeof *workers);
+
+  double start = bench_now();
+  for (int i = 0; i < nthreads; i++) {
+    workers[i].sh = &sh;
+    pthread_create(&workers[i].thread, NULL, swapper, &workers[i]);
+  }
+  size_t maxpending = 0;
+  for (int i = 0; i < nthreads; i++) {
+    pthread_join(workers[i].thread, NULL);
+    if (workers[i].maxpending > maxpending) maxpending = workers[i].maxpending;
+  }
+  double elapsed = bench_now() - start;
+
+  size_t total = (size_t) nthreads * NSWAPS;
+  printf("  %-10s %2d thread(s) %10.2f M retires/s %8.1f ns/retire, <= %zu pending/thread\n",
+         hazards ? "hazards" : "epochs", nthreads, total / elapsed * 1e-6, elapsed * 1e9 / total,
+         maxpending);
+
+  ebr_destroy(sh.ebr);
+  free(atomic_load(&sh.slot));
+  free(workers);
+}
+
+void bench_ebr(void) {
+  read_overhead();
+
+  long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+  int maxthreads = ncpu > 4 ? (int) ncpu : 4;
+
+  bench_section("ebr reclamation throughput (read, swap and retire one shared node)");
+  for (int n = 1; n <= maxthreads; n *= 2) {
+    run(0, n);
+    run(1, n);
+  }
+}
@@ -0,0 +1,68 @@
+#include "bench.h"
+#include "extsort.h"
+#include "list.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BUDGET (2 * 1024 * 1024)
+
+static int u64cmp(const uint64_t *a, const uint64_t *b) { return (*a > *b) - (*a < *b); }
+
+static size_t encodeu64(const void *item, void *buf, size_t size) {
+  if (size >= sizeof(uint64_t)) memcpy(buf, item, sizeof(uint64_t));
+  return sizeof(uint64_t);
+}
+
+static void *decodeu64(const void *buf, size_t size) {
+  (void) size;
+  uint64_t *item = malloc(sizeof *item);
+  if (item) memcpy(item, buf, sizeof *item);
+  return item;
+}
+
+static const extsort_codec_t u64codec = {encodeu64, decodeu64};
+
+static void run(size_t factor) {
+  size_t n = factor * BUDGET / (sizeof(uint64_t) + EXTSORT_ITEM_OVERHEAD);
+  uint64_t seed = 0x9E3779B97F4A7C15ULL;
+  char label[64];
+
+  extsort_t *es = extsort_create((cmp_fn) u64cmp, &u64codec, BUDGET, free);
+
+  bench_t b;
+  snprintf(label, sizeof label, "%zux budget: push + spill (%zu items)", factor, n);
+  bench_begin(&b, label);
+  for (size_t i = 0; i < n; i++) {
+    uint64_t *item = malloc(sizeof *item);
+    *item = bench_rand(&seed);
+    extsort_push(es, item);
+  }
+  extsort_finish(es);
+  bench_end(&b, n);
+
+  snprintf(label, sizeof label, "%zux budget: merge %zu runs", factor, extsort_runs(es));
+  bench_begin(&b, label);
+  uint64_t prev = 0;
+  size_t count = 0;
+  while (extsort_hasnext(es)) {
+    uint64_t *item = extsort_next(es);
+    if (*item < prev) printf("  error: output is not sorted\n");
+    prev = *item;
+    count++;
+    free(item);
+  }
+  bench_end(&b, n);
+
+  if (count != n) printf("  error: expected %zu items, got %zu\n", n, count);
+  extsort_destroy(es);
+}
+
+void bench_extsort(void) {
+  bench_section("extsort (2 MiB budget)");
+  run(2);
+  run(10);
+  run(50);
+}
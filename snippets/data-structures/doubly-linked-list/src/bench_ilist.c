@@ -0,0 +1,113 @@
+#include "bench.h"
+#include "ilist.h"
+#include "list.h"
+
+#include <malloc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NITEMS 1000000
+#define NWALKS 10
+
+static int u64cmp(const uint64_t *a, const uint64_t *b) { return (*a > *b) - (*a < *b); }
+
+/* the walks only chase links, the items themselves are not read */
+static uintptr_t walk_list(list_t *list) {
+  uintptr_t acc = 0;
+  list_iter_t *iter = list_createiter(list);
+  for (int w = 0; w < NWALKS; w++) {
+    while (list_hasnext(iter)) {
+      acc ^= (uintptr_t) list_next(iter);
+    }
+    list_resetiter(iter);
+  }
+  list_destroyiter(iter);
+  return acc;
+}
+
+static uintptr_t walk_ilist(ilist_t *list) {
+  uintptr_t acc = 0;
+  ilist_iter_t *iter = ilist_createiter(list);
+  for (int w = 0; w < NWALKS; w++) {
+    while (ilist_hasnext(iter)) {
+      acc ^= (uintptr_t) ilist_next(iter);
+    }
+    ilist_resetiter(iter);
+  }
+  ilist_destroyiter(iter);
+  return acc;
+}
+
+static void print_bytes(const char *name, memstat_t *stat, size_t heap) {
+  printf("  %-44s %10.1f bytes/elem (%.1f with malloc overhead)\n", name,
+         (double) stat->inuse / NITEMS, (double) heap / NITEMS);
+}
+
+void bench_ilist(void) {
+  uint64_t seed = 0x2545F4914F6CDD1DULL;
+  uint64_t *keys = malloc(NITEMS * sizeof *keys);
+  for (size_t i = 0; i < NITEMS; i++) {
+    keys[i] = bench_rand(&seed);
+  }
+
+  bench_t b;
+  memstat_t stat;
+  uintptr_t acc = 0;
+
+  bench_section("ilist vs list_t (1M items)");
+
+  size_t heap = mallinfo2().uordblks;
+  list_t *list = list_create((cmp_fn) u64cmp);
+  for (size_t i = 0; i < NITEMS; i++) {
+    list_addlast(list, &keys[i]);
+  }
+  heap = mallinfo2().uordblks - heap;
+  list_memstat(list, &stat);
+  print_bytes("list_t", &stat, heap);
+
+  heap = mallinfo2().uordblks;
+  ilist_t *ilist = ilist_create((cmp_fn) u64cmp);
+  for (size_t i = 0; i < NITEMS; i++) {
+    ilist_addlast(ilist, &keys[i]);
+  }
+  heap = mallinfo2().uordblks - heap;
+  ilist_memstat(ilist, &stat);
+  print_bytes("ilist", &stat, heap);
+
+  bench_begin(&b, "list_t: walk, built in order");
+  acc ^= walk_list(list);
+  bench_end(&b, NITEMS * NWALKS);
+
+  bench_begin(&b, "ilist: walk, built in order");
+  acc ^= walk_ilist(ilist);
+  bench_end(&b, NITEMS * NWALKS);
+
+  // sorting random keys relinks the nodes, so traversal order no longer matches memory order
+  list_sort(list);
+  ilist_sort(ilist);
+
+  bench_begin(&b, "list_t: walk, after list_sort");
+  acc ^= walk_list(list);
+  bench_end(&b, NITEMS * NWALKS);
+
+  bench_begin(&b, "ilist: walk, after ilist_sort");
+  acc ^= walk_ilist(ilist);
+  bench_end(&b, NITEMS * NWALKS);
+
+  bench_begin(&b, "ilist: ilist_compact");
+  ilist_compact(ilist);
+  bench_end(&b, NITEMS);
+
+  bench_begin(&b, "ilist: walk, after ilist_compact");
+  acc ^= walk_ilist(ilist);
+  bench_end(&b, NITEMS * NWALKS);
+
+  ilist_memstat(ilist, &stat);
+  print_bytes("ilist, after ilist_compact", &stat, stat.inuse);
+
+  if (acc == 42) printf("\n");
+  list_destroy(list, NULL);
+  ilist_destroy(ilist, NULL);
+  free(keys);
+}
@@ -0,0 +1,141 @@
+#include "bench.h"
+#include "list.h"
+#include "pqueue.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define READYLEN  1000
+#define LISTOPS   10000
+#define HEAPOPS   1000000
+#define NITEMS    1000000
+
+static int u64cmp(const uint64_t *a, const uint64_t *b) { return (*a > *b) - (*a < *b); }
+
+/* plain binary heap of item pointers, for comparison */
+typedef struct binheap {
+  void **items;
+  size_t length;
+  cmp_fn cmpfn;
+} binheap_t;
+
+__attribute__((noipa)) static void binheap_push(binheap_t *h, void *item) {
+  size_t i = h->length++;
+  while (i > 0) {
+    size_t parent = (i - 1) / 2;
+    if (h->cmpfn(item, h->items[parent]) >= 0) break;
+    h->items[i] = h->items[parent];
+    i = parent;
+  }
+  h->items[i] = item;
+}
+
+__attribute__((noipa)) static void *binheap_pop(binheap_t *h) {
+  void *top = h->items[0];
+  void *item = h->items[--h->length];
+  size_t i = 0;
+
+  for (;;) {
+    size_t child = 2 * i + 1;
+    if (child >= h->length) break;
+    if (child + 1 < h->length && h->cmpfn(h->items[child + 1], h->items[child]) < 0) child++;
+    if (h->cmpfn(h->items[child], item) >= 0) break;
+    h->items[i] = h->items[child];
+    i = child;
+  }
+  if (h->length > 0) h->items[i] = item;
+
+  return top;
+}
+
+void bench_pqueue(void) {
+  uint64_t seed = 0xC0FFEE;
+  uint64_t *keys = malloc(NITEMS * sizeof *keys);
+  void **items = malloc(NITEMS * sizeof *items);
+  for (size_t i = 0; i < NITEMS; i++) {
+    keys[i] = bench_rand(&seed);
+    items[i] = &keys[i];
+  }
+
+  binheap_t bh = {malloc(NITEMS * sizeof(void *)), 0, (cmp_fn) u64cmp};
+  pqueue_t *pq = pqueue_create((cmp_fn) u64cmp);
+  list_t *list = list_create((cmp_fn) u64cmp);
+  bench_t b;
+  uint64_t sum = 0;
+
+  bench_section("pqueue vs sort-after-insert list_t vs binary heap, ready queue of 1000");
+
+  for (size_t i = 0; i < READYLEN; i++) {
+    list_addlast(list, items[i]);
+    binheap_push(&bh, items[i]);
+    pqueue_push(pq, items[i], NULL);
+  }
+  list_sort(list);
+
+  /* each step pops the smallest item and pushes a new one */
+  bench_begin(&b, "list_t: list_popfirst + list_addlast/list_sort");
+  for (size_t i = 0; i < LISTOPS; i++) {
+    sum += *(uint64_t *) list_popfirst(list);
+    list_addlast(list, items[READYLEN + i]);
+    list_sort(list);
+  }
+  bench_end(&b, LISTOPS);
+
+  bench_begin(&b, "binary heap: pop + push");
+  for (size_t i = 0; i < HEAPOPS; i++) {
+    sum += *(uint64_t *) binheap_pop(&bh);
+    binheap_push(&bh, items[(READYLEN + i) % NITEMS]);
+  }
+  bench_end(&b, HEAPOPS);
+
+  bench_begin(&b, "pqueue: pqueue_pop + pqueue_push");
+  for (size_t i = 0; i < HEAPOPS; i++) {
+    sum += *(uint64_t *) pqueue_pop(pq);
+    pqueue_push(pq, items[(READYLEN + i) % NITEMS], NULL);
+  }
+  bench_end(&b, HEAPOPS);
+
+  list_destroy(list, NULL);
+  pqueue_destroy(pq, NULL);
+
+  bench_section("pqueue vs binary heap (1M items)");
+
+  bh.length = 0;
+  pq = pqueue_create((cmp_fn) u64cmp);
+
+  bench_begin(&b, "binary heap: push");
+  for (size_t i = 0; i < NITEMS; i++) {
+    binheap_push(&bh, items[i]);
+  }
+  bench_end(&b, NITEMS);
+
+  bench_begin(&b, "pqueue: pqueue_push");
+  for (size_t i = 0; i < NITEMS; i++) {
+    pqueue_push(pq, items[i], NULL);
+  }
+  bench_end(&b, NITEMS);
+
+  bench_begin(&b, "binary heap: pop");
+  for (size_t i = 0; i < NITEMS; i++) {
+    sum += *(uint64_t *) binheap_pop(&bh);
+  }
+  bench_end(&b, NITEMS);
+
+  bench_begin(&b, "pqueue: pqueue_pop");
+  for (size_t i = 0; i < NITEMS; i++) {
+    sum += *(uint64_t *) pqueue_pop(pq);
+  }
+  bench_end(&b, NITEMS);
+
+  bench_begin(&b, "pqueue: pqueue_heapify");
+  pqueue_heapify(pq, items, NITEMS, NULL);
+  bench_end(&b, NITEMS);
+
+  pqueue_destroy(pq, NULL);
+
+  if (sum == 42) printf("\n");
+  free(bh.items);
+  free(items);
+  free(keys);
+}
@@ -0,0 +1,114 @@
+#include "bench.h"
+#include "list.h"
+#include "pvec.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NITEMS 100000
+#define NSNAPS 64
+
+static int u64cmp(const uint64_t *a, const uint64_t *b) { return (*a > *b) - (*a < *b); }
+
+/* the copy a reader gets today */
+static list_t *copy_list(list_t *list) {
+  list_t *copy = list_create((cmp_fn) u64cmp);
+  list_iter_t *iter = list_createiter(list);
+  while (list_hasnext(iter)) {
+    list_addlast(copy, list_next(iter));
+  }
+  list_destroyiter(iter);
+  return copy;
+}
+
+/*
+ * The writer replaces the last item `every` times between two snapshots. A reader holds each
+ * snapshot until the next one is taken.
+ */
+static void run(list_t *list, pvec_t *vec, uint64_t *keys, size_t every) {
+  char name[64];
+  bench_t b;
+  size_t nupdates = NSNAPS * every;
+
+  snprintf(name, sizeof name, "list_t: copy every %zu updates", every);
+  bench_begin(&b, name);
+  list_t *copy = copy_list(list);
+  for (size_t i = 0; i < nupdates; i++) {
+    list_addlast(list, &keys[(i + list_length(list)) % NITEMS]);
+    list_poplast(list);
+    if (every - 1 == i % every) {
+      list_destroy(copy, NULL);
+      copy = copy_list(list);
+    }
+  }
+  list_destroy(copy, NULL);
+  bench_end(&b, nupdates);
+
+  snprintf(name, sizeof name, "pvec: snapshot every %zu updates", every);
+  bench_begin(&b, name);
+  pvec_t *snap = pvec_snapshot(vec);
+  for (size_t i = 0; i < nupdates; i++) {
+    pvec_poplast(vec);
+    pvec_addlast(vec, &keys[(i + pvec_length(vec)) % NITEMS]);
+    if (every - 1 == i % every) {
+      pvec_destroy(snap);
+      snap = pvec_snapshot(vec);
+    }
+  }
+  pvec_destroy(snap);
+  bench_end(&b, nupdates);
+}
+
+void bench_pvec(void) {
+  uint64_t seed = 7;
+  uint64_t *keys = malloc(NITEMS * sizeof *keys);
+  list_t *list = list_create((cmp_fn) u64cmp);
+  pvec_t *vec = pvec_create();
+  for (size_t i = 0; i < NITEMS; i++) {
+    keys[i] = bench_rand(&seed);
+    list_addlast(list, &keys[i]);
+    pvec_addlast(vec, &keys[i]);
+  }
+
+  bench_section("pvec snapshots vs list_t copies (100K items, time per update)");
+  size_t every[] = {1, 16, 256, 4096};
+  for (size_t i = 0; i < sizeof every / sizeof every[0]; i++) {
+    run(list, vec, keys, every[i]);
+  }
+
+  bench_section("pvec vs list_t, reading a snapshot (100K items)");
+  bench_t b;
+  uint64_t sum = 0;
+
+  list_t *copy = copy_list(list);
+  bench_begin(&b, "list_t: iterate copy");
+  list_iter_t *liter = list_createiter(copy);
+  while (list_hasnext(liter)) {
+    sum += *(uint64_t *) list_next(liter);
+  }
+  list_destroyiter(liter);
+  bench_end(&b, NITEMS);
+
+  pvec_t *snap = pvec_snapshot(vec);
+  bench_begin(&b, "pvec: iterate snapshot");
+  pvec_iter_t *piter = pvec_createiter(snap);
+  while (pvec_hasnext(piter)) {
+    sum += *(uint64_t *) pvec_next(piter);
+  }
+  pvec_destroyiter(piter);
+  bench_end(&b, NITEMS);
+
+  bench_begin(&b, "pvec: pvec_get, random index");
+  for (size_t i = 0; i < NITEMS; i++) {
+    sum += *(uint64_t *) pvec_get(snap, bench_rand(&seed) % NITEMS);
+  }
+  bench_end(&b, NITEMS);
+
+  if (sum == 42) printf("\n");
+  list_destroy(copy, NULL);
+  list_destroy(list, NULL);
+  pvec_destroy(snap);
+  pvec_destroy(vec);
+  free(keys);
+}
@@ -0,0 +1,161 @@
+#include "bench.h"
+#include "list.h"
+#include "rculist.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NITEMS    1000
+#define DURATION  0.2
+#define WRITE_GAP 1000000 /* ns between writer updates */
+
+enum mode { MODE_RCU, MODE_RWLOCK, MODE_MUTEX };
+
+typedef struct shared {
+  enum mode mode;
+  rculist_t *rcu;
+  list_t *list;
+  pthread_rwlock_t rwlock;
+  pthread_mutex_t mutex;
+  double end;
+  int items[NITEMS];
+} shared_t;
+
+typedef struct worker {
+  pthread_t thread;
+  shared_t *sh;
+  size_t visited;
+} worker_t;
+
+static int intcmp(const int *a, const int *b) { return *a - *b; }
+
+static void *reader(void *arg) {
+  worker_t *w = arg;
+  shared_t *sh = w->sh;
+  size_t visited = 0;
+  long sum = 0;
+
+  if (MODE_RCU == sh->mode) {
+    rculist_reader_t *r = rculist_register(sh->rcu);
+    rculist_iter_t *iter = rculist_createiter(r);
+    while (bench_now() < sh->end) {
+      rculist_resetiter(iter);
+      while (rculist_hasnext(iter)) {
+        sum += *(int *) rculist_next(iter);
+        visited++;
+      }
+      rculist_quiescent(r);
+    }
+    rculist_destroyiter(iter);
+    rculist_unregister(r);
+  } else {
+    list_iter_t *iter = list_createiter(sh->list);
+    while (bench_now() < sh->end) {
+      if (MODE_RWLOCK == sh->mode) {
+        pthread_rwlock_rdlock(&sh->rwlock);
+      } else {
+        pthread_mutex_lock(&sh->mutex);
+      }
+      list_resetiter(iter);
+      while (list_hasnext(iter)) {
+        sum += *(int *) list_next(iter);
+        visited++;
+      }
+      if (MODE_RWLOCK == sh->mode) {
+        pthread_rwlock_unlock(&sh->rwlock);
+      } else {
+        pthread_mutex_unlock(&sh->mutex);
+      }
+    }
+    list_destroyiter(iter);
+  }
+
+  w->visited = visited + (sum == 42);
+  return NULL;
+}
+
+/* occasionally moves a random subscriber to the end of the list */
+static void writer(shared_t *sh) {
+  uint64_t seed = 12345;
+  struct timespec gap = {0, WRITE_GAP};
+  while (bench_now() < sh->end) {
+    int *item = &sh->items[bench_rand(&seed) % NITEMS];
+    if (MODE_RCU == sh->mode) {
+      rculist_remove(sh->rcu, item, NULL);
+      rculist_addlast(sh->rcu, item);
+    } else if (MODE_RWLOCK == sh->mode) {
+      pthread_rwlock_wrlock(&sh->rwlock);
+      list_remove(sh->list, item);
+      list_addlast(sh->list, item);
+      pthread_rwlock_unlock(&sh->rwlock);
+    } else {
+      pthread_mutex_lock(&sh->mutex);
+      list_remove(sh->list, item);
+      list_addlast(sh->list, item);
+      pthread_mutex_unlock(&sh->mutex);
+    }
+    nanosleep(&gap, NULL);
+  }
+}
+
+static void run(enum mode mode, const char *name, int nthreads) {
+  shared_t *sh = malloc(sizeof *sh);
+  worker_t *workers = malloc(nthreads * sizeof *workers);
+
+  sh->mode = mode;
+  sh->rcu = rculist_create((cmp_fn) intcmp);
+  sh->list = list_create((cmp_fn) intcmp);
+  /* glibc rwlocks prefer readers by default, which starves the writer */
+  pthread_rwlockattr_t attr;
+  pthread_rwlockattr_init(&attr);
+  pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+  pthread_rwlock_init(&sh->rwlock, &attr);
+  pthread_rwlockattr_destroy(&attr);
+  pthread_mutex_init(&sh->mutex, NULL);
+  for (int i = 0; i < NITEMS; i++) {
+    sh->items[i] = i;
+    rculist_addlast(sh->rcu, &sh->items[i]);
+    list_addlast(sh->list, &sh->items[i]);
+  }
+
+  double start = bench_now();
+  sh->end = start + DURATION;
+  for (int i = 0; i < nthreads; i++) {
+    workers[i].sh = sh;
+    pthread_create(&workers[i].thread, NULL, reader, &workers[i]);
+  }
+  writer(sh);
+
+  size_t visited = 0;
+  for (int i = 0; i < nthreads; i++) {
+    pthread_join(workers[i].thread, NULL);
+    visited += workers[i].visited;
+  }
+  double elapsed = bench_now() - start;
+
+  printf("  %-10s %2d reader(s) %12.1f M items/s %10.1f M items/s/thread\n", name, nthreads,
+         visited / elapsed * 1e-6, visited / elapsed * 1e-6 / nthreads);
+
+  rculist_synchronize(sh->rcu);
+  rculist_destroy(sh->rcu, NULL);
+  list_destroy(sh->list, NULL);
+  pthread_rwlock_destroy(&sh->rwlock);
+  pthread_mutex_destroy(&sh->mutex);
+  free(workers);
+  free(sh);
+}
+
+void bench_rculist(void) {
+  long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+  int maxthreads = ncpu > 4 ? (int) ncpu : 4;
+
+  bench_section("rculist reader scaling (1000 items, writer every 1 ms)");
+  for (int n = 1; n <= maxthreads; n *= 2) {
+    run(MODE_RCU, "rculist", n);
+    run(MODE_RWLOCK, "rwlock", n);
+    run(MODE_MUTEX, "mutex", n);
+  }
+}
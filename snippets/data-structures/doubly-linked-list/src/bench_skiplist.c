@@ -0,0 +1,110 @@
+#include "bench.h"
+#include "list.h"
+#include "skiplist.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NITEMS  50000
+#define BATCH   1000
+#define LOOKUPS 20
+#define SCANLEN 100
+
+static int u64cmp(const uint64_t *a, const uint64_t *b) { return (*a > *b) - (*a < *b); }
+
+/* batches of inserts, each followed by point lookups and a short range scan */
+static void run_list(uint64_t *keys, uint64_t *probes) {
+  list_t *list = list_create((cmp_fn) u64cmp);
+  double insert = 0, lookup = 0, scan = 0, t;
+  size_t found = 0, scanned = 0;
+
+  for (size_t b = 0; b < NITEMS / BATCH; b++) {
+    t = bench_now();
+    for (size_t i = b * BATCH; i < (b + 1) * BATCH; i++) {
+      list_addlast(list, &keys[i]);
+    }
+    list_sort(list);
+    insert += bench_now() - t;
+
+    t = bench_now();
+    for (size_t i = 0; i < LOOKUPS; i++) {
+      found += list_contains(list, &probes[b * LOOKUPS + i]);
+    }
+    lookup += bench_now() - t;
+
+    t = bench_now();
+    list_iter_t *iter = list_createiter(list);
+    size_t n = 0;
+    while (list_hasnext(iter) && n < SCANLEN) {
+      uint64_t *item = list_next(iter);
+      if (*item >= probes[b * LOOKUPS]) n++;
+    }
+    scanned += n;
+    list_destroyiter(iter);
+    scan += bench_now() - t;
+  }
+
+  printf("  %-44s %10.3f ms\n", "list_t: addlast + list_sort per batch", insert * 1e3);
+  printf("  %-44s %10.3f ms (%zu found)\n", "list_t: list_contains", lookup * 1e3, found);
+  printf("  %-44s %10.3f ms (%zu scanned)\n", "list_t: range scan", scan * 1e3, scanned);
+  list_destroy(list, NULL);
+}
+
+static void run_skiplist(uint64_t *keys, uint64_t *probes) {
+  skiplist_t *sl = skiplist_create((cmp_fn) u64cmp);
+  double insert = 0, lookup = 0, scan = 0, t;
+  size_t found = 0, scanned = 0;
+
+  for (size_t b = 0; b < NITEMS / BATCH; b++) {
+    t = bench_now();
+    for (size_t i = b * BATCH; i < (b + 1) * BATCH; i++) {
+      skiplist_insert(sl, &keys[i]);
+    }
+    insert += bench_now() - t;
+
+    t = bench_now();
+    for (size_t i = 0; i < LOOKUPS; i++) {
+      found += skiplist_contains(sl, &probes[b * LOOKUPS + i]);
+    }
+    lookup += bench_now() - t;
+
+    t = bench_now();
+    skiplist_iter_t *iter = skiplist_lowerbound(sl, &probes[b * LOOKUPS]);
+    size_t n = 0;
+    while (skiplist_hasnext(iter) && n < SCANLEN) {
+      skiplist_next(iter);
+      n++;
+    }
+    scanned += n;
+    skiplist_destroyiter(iter);
+    scan += bench_now() - t;
+  }
+
+  printf("  %-44s %10.3f ms\n", "skiplist_t: skiplist_insert", insert * 1e3);
+  printf("  %-44s %10.3f ms (%zu found)\n", "skiplist_t: skiplist_contains", lookup * 1e3, found);
+  printf("  %-44s %10.3f ms (%zu scanned)\n", "skiplist_t: lowerbound scan", scan * 1e3, scanned);
+  skiplist_destroy(sl, NULL);
+}
+
+void bench_skiplist(void) {
+  uint64_t seed = 0x9E3779B97F4A7C15ULL;
+  uint64_t *keys = malloc(NITEMS * sizeof *keys);
+  uint64_t *probes = malloc((NITEMS / BATCH) * LOOKUPS * sizeof *probes);
+
+  for (size_t i = 0; i < NITEMS; i++) {
+    keys[i] = bench_rand(&seed);
+  }
+  /* half of the probes hit an item inserted in the same or an earlier batch */
+  for (size_t i = 0; i < (NITEMS / BATCH) * LOOKUPS; i++) {
+    size_t batch = i / LOOKUPS;
+    probes[i] = (i % 2) ? keys[bench_rand(&seed) % ((batch + 1) * BATCH)] : bench_rand(&seed);
+  }
+
+  bench_section("skiplist vs sort-then-scan list_t (50k items, batches of 1000)");
+  run_list(keys, probes);
+  run_skiplist(keys, probes);
+
+  free(keys);
+  free(probes);
+}
@@ -0,0 +1,118 @@
+#include "bench.h"
+#include "list.h"
+#include "threadpool.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define NITEMS 20000
+#define WORK   1000
+
+static int u64cmp(const uint64_t *a, const uint64_t *b) { return (*a > *b) - (*a < *b); }
+
+/* a CPU-bound function of one item, a few microseconds */
+static uint64_t work(const uint64_t *item) {
+  uint64_t x = *item | 1;
+  for (int i = 0; i < WORK; i++) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+  }
+  return x;
+}
+
+static void apply(uint64_t *item, void *ctx) {
+  (void) ctx;
+  item[NITEMS] = work(item);
+}
+
+static void *map(uint64_t *item, void *ctx) {
+  (void) ctx;
+  item[NITEMS] = work(item);
+  return &item[NITEMS];
+}
+
+static int pred(uint64_t *item, void *ctx) {
+  (void) ctx;
+  return work(item) & 1;
+}
+
+static void fold(uint64_t *acc, uint64_t *item, void *ctx) {
+  (void) ctx;
+  *acc += work(item);
+}
+
+static void combine(uint64_t *acc, uint64_t *other, void *ctx) {
+  (void) ctx;
+  *acc += *other;
+}
+
+static void run(threadpool_t *pool, list_t *list, uint64_t *sum) {
+  char name[64];
+  bench_t b;
+  size_t nthreads = threadpool_nthreads(pool);
+
+  snprintf(name, sizeof name, "list_foreach, %zu threads", nthreads);
+  bench_begin(&b, name);
+  list_foreach(pool, list, (list_foreach_fn) apply, NULL);
+  bench_end(&b, NITEMS);
+
+  snprintf(name, sizeof name, "list_map, %zu threads", nthreads);
+  bench_begin(&b, name);
+  list_t *mapped = list_map(pool, list, (list_map_fn) map, NULL, (cmp_fn) u64cmp);
+  bench_end(&b, NITEMS);
+  *sum += list_length(mapped);
+  list_destroy(mapped, NULL);
+
+  snprintf(name, sizeof name, "list_filter, %zu threads", nthreads);
+  bench_begin(&b, name);
+  list_t *filtered = list_filter(pool, list, (list_pred_fn) pred, NULL);
+  bench_end(&b, NITEMS);
+  *sum += list_length(filtered);
+  list_destroy(filtered, NULL);
+
+  snprintf(name, sizeof name, "list_reduce, %zu threads", nthreads);
+  uint64_t acc = 0;
+  bench_begin(&b, name);
+  list_reduce(pool, list, (list_reduce_fn) fold, (list_reduce_fn) combine, &acc, sizeof acc, NULL);
+  bench_end(&b, NITEMS);
+  *sum += acc;
+}
+
+void bench_threadpool(void) {
+  /* items, followed by room for the results of apply and map */
+  uint64_t *keys = malloc(2 * NITEMS * sizeof *keys);
+  uint64_t seed = 0x7EA;
+  list_t *list = list_create((cmp_fn) u64cmp);
+  for (size_t i = 0; i < NITEMS; i++) {
+    keys[i] = bench_rand(&seed);
+    list_addlast(list, &keys[i]);
+  }
+
+  long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+  char title[96];
+  snprintf(title, sizeof title, "parallel list operations on CPU-bound items (%ld CPUs online)", ncpu);
+  bench_section(title);
+
+  uint64_t sum = 0;
+  bench_t b;
+  bench_begin(&b, "list_createiter/list_next loop");
+  list_iter_t *iter = list_createiter(list);
+  while (list_hasnext(iter)) {
+    sum += work(list_next(iter));
+  }
+  list_destroyiter(iter);
+  bench_end(&b, NITEMS);
+
+  for (size_t nthreads = 1; nthreads <= 8; nthreads *= 2) {
+    threadpool_t *pool = threadpool_create(nthreads);
+    run(pool, list, &sum);
+    threadpool_destroy(pool);
+  }
+
+  if (sum == 42) printf("\n");
+  list_destroy(list, NULL);
+  free(keys);
+}
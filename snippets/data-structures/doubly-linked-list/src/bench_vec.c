@@ -0,0 +1,135 @@
+#include "bench.h"
+#include "list.h"
+#include "pdqsort.h"
+#include "vec.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NITEMS   1000000
+#define NSEARCH  100000
+#define LOOKUPS  50
+
+static int u64cmp(const uint64_t *a, const uint64_t *b) { return (*a > *b) - (*a < *b); }
+
+static void sum_list(list_t *list, uint64_t *sum) {
+  list_iter_t *iter = list_createiter(list);
+  while (list_hasnext(iter)) {
+    *sum += *(uint64_t *) list_next(iter);
+  }
+  list_destroyiter(iter);
+}
+
+static void sum_vec(vec_t *vec, uint64_t *sum) {
+  void **items = vec_items(vec);
+  for (size_t i = 0; i < vec_length(vec); i++) {
+    *sum += *(uint64_t *) items[i];
+  }
+}
+
+void bench_vec(void) {
+  uint64_t seed = 0x9E3779B97F4A7C15ULL;
+  uint64_t *keys = malloc(NITEMS * sizeof *keys);
+  for (size_t i = 0; i < NITEMS; i++) {
+    keys[i] = bench_rand(&seed);
+  }
+
+  list_t *list = list_create((cmp_fn) u64cmp);
+  vec_t *vec = vec_create((cmp_fn) u64cmp);
+  bench_t b;
+  uint64_t sum = 0;
+
+  bench_section("vec vs list_t (1M items)");
+
+  bench_begin(&b, "list_t: list_addlast");
+  for (size_t i = 0; i < NITEMS; i++) {
+    list_addlast(list, &keys[i]);
+  }
+  bench_end(&b, NITEMS);
+
+  bench_begin(&b, "vec: vec_addlast");
+  for (size_t i = 0; i < NITEMS; i++) {
+    vec_addlast(vec, &keys[i]);
+  }
+  bench_end(&b, NITEMS);
+
+  bench_begin(&b, "list_t: iterate");
+  sum_list(list, &sum);
+  bench_end(&b, NITEMS);
+
+  bench_begin(&b, "vec: iterate");
+  sum_vec(vec, &sum);
+  bench_end(&b, NITEMS);
+
+  bench_begin(&b, "list_t: list_sort");
+  list_sort(list);
+  bench_end(&b, NITEMS);
+
+  bench_begin(&b, "vec: vec_sort (pdqsort)");
+  vec_sort(vec);
+  bench_end(&b, NITEMS);
+
+  bench_begin(&b, "list_t: iterate after sort");
+  sum_list(list, &sum);
+  bench_end(&b, NITEMS);
+
+  bench_begin(&b, "vec: iterate after sort");
+  sum_vec(vec, &sum);
+  bench_end(&b, NITEMS);
+
+  list_destroy(list, NULL);
+  vec_destroy(vec, NULL);
+
+  /* linear search on smaller containers, and binary search on the sorted vec */
+  list = list_create((cmp_fn) u64cmp);
+  vec = vec_create((cmp_fn) u64cmp);
+  for (size_t i = 0; i < NSEARCH; i++) {
+    list_addlast(list, &keys[i]);
+    vec_addlast(vec, &keys[i]);
+  }
+
+  size_t found = 0;
+  bench_begin(&b, "list_t: list_contains (100k items)");
+  for (size_t i = 0; i < LOOKUPS; i++) {
+    found += list_contains(list, &keys[bench_rand(&seed) % (2 * NSEARCH)]);
+  }
+  bench_end(&b, LOOKUPS);
+
+  bench_begin(&b, "vec: vec_contains (100k items)");
+  for (size_t i = 0; i < LOOKUPS; i++) {
+    found += vec_contains(vec, &keys[bench_rand(&seed) % (2 * NSEARCH)]);
+  }
+  bench_end(&b, LOOKUPS);
+
+  vec_sort(vec);
+  bench_begin(&b, "vec: vec_bsearch (100k items)");
+  for (size_t i = 0; i < 1000 * LOOKUPS; i++) {
+    found += vec_bsearch(vec, &keys[bench_rand(&seed) % (2 * NSEARCH)], NULL);
+  }
+  bench_end(&b, 1000 * LOOKUPS);
+
+  list_destroy(list, NULL);
+  vec_destroy(vec, NULL);
+
+  /* plain arrays of values */
+  uint64_t *copy = malloc(NITEMS * sizeof *copy);
+  memcpy(copy, keys, NITEMS * sizeof *copy);
+  bench_begin(&b, "qsort (1M u64 values)");
+  qsort(copy, NITEMS, sizeof *copy, (cmp_fn) u64cmp);
+  bench_end(&b, NITEMS);
+
+  memcpy(copy, keys, NITEMS * sizeof *copy);
+  bench_begin(&b, "pdqsort (1M u64 values)");
+  pdqsort(copy, NITEMS, sizeof *copy, (cmp_fn) u64cmp);
+  bench_end(&b, NITEMS);
+
+  bench_begin(&b, "pdqsort (1M u64 values, already sorted)");
+  pdqsort(copy, NITEMS, sizeof *copy, (cmp_fn) u64cmp);
+  bench_end(&b, NITEMS);
+
+  if (sum == 42 || found == (size_t) -1) printf("\n");
+  free(copy);
+  free(keys);
+}
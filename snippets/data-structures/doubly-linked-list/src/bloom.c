@@ -0,0 +1,181 @@
+#include "alloc.h"
+#include "bloom.h"
+#include "defs.h"
+#include "printing.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHELINE 64
+#define WORDS (BLOOM_BLOCKBITS / 64)
+#define MAXHASHES 16
+
+/*
+ * Items of one block share its bits, so some blocks fill up more than others and the
+ * false-positive rate is higher than that of a classic Bloom filter of the same size.
+ * Adding this fraction of bits per item brings it back to about the target.
+ */
+#define BLOCKED_OVERHEAD 1.2
+
+
+typedef struct block {
+  _Alignas(CACHELINE) uint64_t word[WORDS];
+} block_t;
+
+struct bloom {
+  block_t *blocks;
+  void *raw;            /* unaligned allocation holding `blocks` */
+  size_t rawsize;
+  size_t nblocks;
+  size_t nhashes;
+  size_t capacity;
+  size_t count;
+  double fprate;
+  hash64_fn hashfn;
+  allocator_t allocator;
+  memstat_t mem;
+};
+
+
+/* Finalizer of MurmurHash3, so that weak hash functions (e.g. the identity) spread well */
+static inline uint64_t mix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+/*
+ * Picks the block from the high bits of the hash, and builds the mask of the `nhashes` bits
+ * within it by double hashing on the low bits. The step is odd, so the bits are distinct.
+ */
+static inline block_t *lookup(bloom_t *bf, const void *item, uint64_t mask[WORDS]) {
+  uint64_t h = mix(bf->hashfn(item));
+  size_t index = (size_t) (((h >> 32) * bf->nblocks) >> 32);
+  uint32_t bit = h & (BLOOM_BLOCKBITS - 1);
+  uint32_t step = ((h >> 9) & (BLOOM_BLOCKBITS - 1)) | 1;
+
+  for (size_t w = 0; w < WORDS; w++) {
+    mask[w] = 0;
+  }
+  for (size_t i = 0; i < bf->nhashes; i++) {
+    mask[bit / 64] |= 1ULL << (bit % 64);
+    bit = (bit + step) & (BLOOM_BLOCKBITS - 1);
+  }
+
+  return &bf->blocks[index];
+}
+
+
+bloom_t *bloom_create(hash64_fn hashfn, size_t capacity, double fprate) {
+  return bloom_create_with_allocator(hashfn, capacity, fprate, NULL);
+}
+
+bloom_t *bloom_create_with_allocator(hash64_fn hashfn, size_t capacity, double fprate,
+                                     const allocator_t *allocator) {
+  if (NULL == hashfn) {
+    pr_error("Failed hash function not given\n");
+    return NULL;
+  }
+  if (!(fprate > 0.0 && fprate < 1.0)) {
+    pr_error("False-positive rate must be between 0 and 1, got %f\n", fprate);
+    return NULL;
+  }
+  if (NULL == allocator) allocator = &stdlib_allocator;
+  if (0 == capacity) capacity = 1;
+
+  // classic sizing: -ln(p) / ln(2)^2 bits per item, and -log2(p) bits set per item
+  double bitsperitem = -log(fprate) / (M_LN2 * M_LN2) * BLOCKED_OVERHEAD;
+  size_t nblocks = (size_t) ceil(capacity * bitsperitem / BLOOM_BLOCKBITS);
+  size_t nhashes = (size_t) lround(-log2(fprate));
+  if (nhashes < 1) nhashes = 1;
+  if (nhashes > MAXHASHES) nhashes = MAXHASHES;
+
+  bloom_t *bf = allocator->alloc(allocator->ctx, sizeof *bf);
+  if (NULL == bf) {
+    pr_error("Failed to allocate memory for bloom filter\n");
+    return NULL;
+  }
+
+  bf->allocator = *allocator;
+  bf->mem.inuse = sizeof *bf;
+  bf->mem.peak = sizeof *bf;
+
+  bf->rawsize = nblocks * sizeof(block_t) + CACHELINE - 1;
+  bf->raw = mem_alloc(&bf->allocator, &bf->mem, bf->rawsize);
+  if (NULL == bf->raw) {
+    pr_error("Failed to allocate %zu blocks for bloom filter\n", nblocks);
+    allocator->free(allocator->ctx, bf, sizeof *bf);
+    return NULL;
+  }
+
+  uintptr_t line = ((uintptr_t) bf->raw + CACHELINE - 1) & ~(uintptr_t) (CACHELINE - 1);
+  bf->blocks = (block_t *) line;
+  bf->nblocks = nblocks;
+  bf->nhashes = nhashes;
+  bf->capacity = capacity;
+  bf->fprate = fprate;
+  bf->hashfn = hashfn;
+  bloom_clear(bf);
+
+  return bf;
+}
+
+void bloom_destroy(bloom_t *bf) {
+  if (NULL == bf) return;
+
+  mem_free(&bf->allocator, &bf->mem, bf->raw, bf->rawsize);
+  allocator_t allocator = bf->allocator;
+  allocator.free(allocator.ctx, bf, sizeof *bf);
+}
+
+void bloom_memstat(bloom_t *bf, memstat_t *stat) { *stat = bf->mem; }
+
+void bloom_add(bloom_t *bf, const void *item) {
+  uint64_t mask[WORDS];
+  block_t *block = lookup(bf, item, mask);
+
+  for (size_t w = 0; w < WORDS; w++) {
+    block->word[w] |= mask[w];
+  }
+  bf->count += 1;
+}
+
+int bloom_maycontain(bloom_t *bf, const void *item) {
+  uint64_t mask[WORDS];
+  block_t *block = lookup(bf, item, mask);
+
+  // branch-free over the whole block, so the loop vectorizes
+  uint64_t missing = 0;
+  for (size_t w = 0; w < WORDS; w++) {
+    missing |= mask[w] & ~block->word[w];
+  }
+
+  return 0 == missing;
+}
+
+void bloom_clear(bloom_t *bf) {
+  memset(bf->blocks, 0, bf->nblocks * sizeof(block_t));
+  bf->count = 0;
+}
+
+void bloom_stats(bloom_t *bf, bloom_stats_t *stats) {
+  size_t bitsset = 0;
+  for (size_t i = 0; i < bf->nblocks; i++) {
+    for (size_t w = 0; w < WORDS; w++) {
+      bitsset += __builtin_popcountll(bf->blocks[i].word[w]);
+    }
+  }
+
+  stats->capacity = bf->capacity;
+  stats->count = bf->count;
+  stats->nblocks = bf->nblocks;
+  stats->nhashes = bf->nhashes;
+  stats->fprate = bf->fprate;
+  stats->fill = (double) bitsset / ((double) bf->nblocks * BLOOM_BLOCKBITS);
+  stats->estfprate = pow(stats->fill, (double) bf->nhashes);
+}
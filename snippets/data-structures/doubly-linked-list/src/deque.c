@@ -0,0 +1,242 @@
+#include "alloc.h"
+#include "defs.h"
+#include "deque.h"
+#include "printing.h"
+
+#include <stdlib.h>
+
+#define BLOCKBYTES (DEQUE_BLOCKSIZE * sizeof(void *))
+#define MAP_MINCAP 8
+
+_Static_assert((DEQUE_BLOCKSIZE & (DEQUE_BLOCKSIZE - 1)) == 0, "DEQUE_BLOCKSIZE must be a power of two");
+
+
+/*
+ * Item i is at position `front + i`, counted from the start of the first block in use.
+ * Blocks in use are map[mhead], map[mhead + 1], ... modulo the map capacity.
+ */
+struct deque {
+  void ***map;
+  size_t mapcap;      /* power of two */
+  size_t mhead;
+  size_t nblocks;
+  size_t front;       /* offset of the first item in the first block, < DEQUE_BLOCKSIZE */
+  size_t length;
+  void **spare;       /* one emptied block kept for reuse */
+  cmp_fn cmpfn;
+  allocator_t allocator;
+  memstat_t mem;
+};
+
+
+static inline void **slot(deque_t *dq, size_t pos) {
+  void **block = dq->map[(dq->mhead + pos / DEQUE_BLOCKSIZE) & (dq->mapcap - 1)];
+  return &block[pos % DEQUE_BLOCKSIZE];
+}
+
+static void **getblock(deque_t *dq) {
+  if (NULL != dq->spare) {
+    void **block = dq->spare;
+    dq->spare = NULL;
+    return block;
+  }
+
+  void **block = mem_alloc(&dq->allocator, &dq->mem, BLOCKBYTES);
+  if (NULL == block) pr_error("Failed to allocate deque block\n");
+
+  return block;
+}
+
+static void putblock(deque_t *dq, void **block) {
+  if (NULL == dq->spare) {
+    dq->spare = block;
+  } else {
+    mem_free(&dq->allocator, &dq->mem, block, BLOCKBYTES);
+  }
+}
+
+/* Doubles the map, laying the blocks in use out from index 0 */
+static int growmap(deque_t *dq) {
+  size_t mapcap = dq->mapcap ? dq->mapcap * 2 : MAP_MINCAP;
+  void ***map = mem_alloc(&dq->allocator, &dq->mem, mapcap * sizeof *map);
+  if (NULL == map) {
+    pr_error("Failed to grow deque map\n");
+    return -1;
+  }
+
+  for (size_t i = 0; i < dq->nblocks; i++) {
+    map[i] = dq->map[(dq->mhead + i) & (dq->mapcap - 1)];
+  }
+
+  mem_free(&dq->allocator, &dq->mem, dq->map, dq->mapcap * sizeof *map);
+  dq->map = map;
+  dq->mapcap = mapcap;
+  dq->mhead = 0;
+
+  return 0;
+}
+
+
+deque_t *deque_create(cmp_fn cmpfn) { return deque_create_with_allocator(cmpfn, NULL); }
+
+deque_t *deque_create_with_allocator(cmp_fn cmpfn, const allocator_t *allocator) {
+  if (NULL == cmpfn) {
+    pr_error("Failed compare function not given\n");
+    return NULL;
+  }
+  if (NULL == allocator) allocator = &stdlib_allocator;
+
+  deque_t *dq = allocator->alloc(allocator->ctx, sizeof *dq);
+  if (NULL == dq) {
+    pr_error("Failed to allocate memory for deque\n");
+    return NULL;
+  }
+
+  dq->map = NULL;
+  dq->mapcap = 0;
+  dq->mhead = 0;
+  dq->nblocks = 0;
+  dq->front = 0;
+  dq->length = 0;
+  dq->spare = NULL;
+  dq->cmpfn = cmpfn;
+  dq->allocator = *allocator;
+  dq->mem.inuse = sizeof *dq;
+  dq->mem.peak = sizeof *dq;
+
+  return dq;
+}
+
+void deque_destroy(deque_t *dq, free_fn item_free) {
+  if (NULL == dq) return;
+
+  if (NULL != item_free) {
+    for (size_t i = 0; i < dq->length; i++) {
+      item_free(*slot(dq, dq->front + i));
+    }
+  }
+
+  for (size_t i = 0; i < dq->nblocks; i++) {
+    mem_free(&dq->allocator, &dq->mem, dq->map[(dq->mhead + i) & (dq->mapcap - 1)], BLOCKBYTES);
+  }
+  mem_free(&dq->allocator, &dq->mem, dq->spare, BLOCKBYTES);
+  mem_free(&dq->allocator, &dq->mem, dq->map, dq->mapcap * sizeof *dq->map);
+
+  allocator_t allocator = dq->allocator;
+  allocator.free(allocator.ctx, dq, sizeof *dq);
+}
+
+size_t deque_length(deque_t *dq) { return dq->length; }
+
+void deque_memstat(deque_t *dq, memstat_t *stat) { *stat = dq->mem; }
+
+int deque_addfirst(deque_t *dq, void *item) {
+  if (NULL == dq || NULL == item) {
+    pr_error("Deque parameter and item parameter not given\n");
+    return -1;
+  }
+
+  // no room before the first item, so a new first block is needed
+  if (0 == dq->front) {
+    if (dq->nblocks == dq->mapcap && growmap(dq) < 0) return -1;
+
+    void **block = getblock(dq);
+    if (NULL == block) return -1;
+
+    dq->mhead = (dq->mhead - 1) & (dq->mapcap - 1);
+    dq->map[dq->mhead] = block;
+    dq->nblocks += 1;
+    dq->front = DEQUE_BLOCKSIZE;
+  }
+
+  dq->front -= 1;
+  dq->map[dq->mhead][dq->front] = item;
+  dq->length += 1;
+
+  return 0;
+}
+
+int deque_addlast(deque_t *dq, void *item) {
+  if (NULL == dq || NULL == item) {
+    pr_error("Deque parameter and item parameter not given\n");
+    return -1;
+  }
+
+  size_t pos = dq->front + dq->length;
+
+  // the last block is full (or there are none), so a new last block is needed
+  if (pos == dq->nblocks * DEQUE_BLOCKSIZE) {
+    if (dq->nblocks == dq->mapcap && growmap(dq) < 0) return -1;
+
+    void **block = getblock(dq);
+    if (NULL == block) return -1;
+
+    dq->map[(dq->mhead + dq->nblocks) & (dq->mapcap - 1)] = block;
+    dq->nblocks += 1;
+  }
+
+  *slot(dq, pos) = item;
+  dq->length += 1;
+
+  return 0;
+}
+
+void *deque_popfirst(deque_t *dq) {
+  if (NULL == dq || 0 == dq->length) PANIC("Deque is empty, PANICING(exiting)\n");
+
+  void *returnData = dq->map[dq->mhead][dq->front];
+  dq->front += 1;
+  dq->length -= 1;
+
+  // the first block is used up, release it
+  if (DEQUE_BLOCKSIZE == dq->front) {
+    putblock(dq, dq->map[dq->mhead]);
+    dq->mhead = (dq->mhead + 1) & (dq->mapcap - 1);
+    dq->nblocks -= 1;
+    dq->front = 0;
+  }
+
+  return returnData;
+}
+
+void *deque_poplast(deque_t *dq) {
+  if (NULL == dq || 0 == dq->length) PANIC("Deque is empty, PANICING(exiting)\n");
+
+  dq->length -= 1;
+  void *returnData = *slot(dq, dq->front + dq->length);
+
+  // the last block no longer holds any items, release it
+  if (dq->front + dq->length <= (dq->nblocks - 1) * DEQUE_BLOCKSIZE) {
+    dq->nblocks -= 1;
+    putblock(dq, dq->map[(dq->mhead + dq->nblocks) & (dq->mapcap - 1)]);
+    if (0 == dq->nblocks) dq->front = 0;
+  }
+
+  return returnData;
+}
+
+void *deque_get(deque_t *dq, size_t index) {
+  if (NULL == dq || index >= dq->length) return NULL;
+
+  return *slot(dq, dq->front + index);
+}
+
+int deque_contains(deque_t *dq, void *item) {
+  size_t pos = dq->front;
+  size_t remaining = dq->length;
+
+  // scan block by block
+  for (size_t b = 0; remaining > 0; b++) {
+    void **block = dq->map[(dq->mhead + b) & (dq->mapcap - 1)];
+    size_t end = pos + remaining < DEQUE_BLOCKSIZE ? pos + remaining : DEQUE_BLOCKSIZE;
+
+    for (size_t i = pos; i < end; i++) {
+      if (dq->cmpfn(block[i], item) == 0) return 1;
+    }
+
+    remaining -= end - pos;
+    pos = 0;
+  }
+
+  return 0;
+}
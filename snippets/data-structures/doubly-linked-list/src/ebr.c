@@ -0,0 +1,304 @@
+#include "ebr.h"
+#include "printing.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_LINE 64
+#define ACTIVE     1
+
+
+typedef struct retired {
+  void *ptr;
+  free_fn item_free;
+  uint64_t epoch;
+} retired_t;
+
+/* growable array of retired nodes */
+typedef struct limbo {
+  retired_t *items;
+  size_t length;
+  size_t capacity;
+} limbo_t;
+
+struct ebr_thread {
+  /* 0 outside a critical section, otherwise the observed epoch shifted left, | ACTIVE.
+   * Together with the hazard pointers, the only fields other threads read. */
+  _Alignas(CACHE_LINE) _Atomic uint64_t state;
+  void *_Atomic hazards[EBR_HAZARDS];
+
+  _Alignas(CACHE_LINE) ebr_t *ebr;
+  ebr_thread_t *next;       /* guarded by ebr->lock */
+  size_t depth;
+  limbo_t limbo;
+  void **scratch;           /* hazard pointers seen by the last collect */
+  size_t scratchcap;
+};
+
+struct ebr {
+  _Alignas(CACHE_LINE) _Atomic uint64_t epoch;
+
+  _Alignas(CACHE_LINE) pthread_mutex_t lock;  /* guards the registry and the orphans */
+  ebr_thread_t *threads;
+  limbo_t orphans;          /* retired by threads that unregistered */
+  atomic_size_t norphans;
+};
+
+
+static int limbo_push(limbo_t *limbo, retired_t r) {
+  if (limbo->length == limbo->capacity) {
+    size_t capacity = limbo->capacity ? limbo->capacity * 2 : EBR_RETIRE_BATCH * 2;
+    retired_t *items = realloc(limbo->items, capacity * sizeof *items);
+    if (NULL == items) return -1;
+
+    limbo->items = items;
+    limbo->capacity = capacity;
+  }
+
+  limbo->items[limbo->length++] = r;
+  return 0;
+}
+
+static void limbo_freeall(limbo_t *limbo) {
+  for (size_t i = 0; i < limbo->length; i++) {
+    limbo->items[i].item_free(limbo->items[i].ptr);
+  }
+  free(limbo->items);
+  *limbo = (limbo_t) {NULL, 0, 0};
+}
+
+/* Bumps the epoch if every thread in a critical section has observed it. Call with the lock */
+static void tryadvance(ebr_t *ebr) {
+  // orders unlinks before the scan, against the exchange in ebr_enter
+  atomic_thread_fence(memory_order_seq_cst);
+  uint64_t epoch = atomic_load_explicit(&ebr->epoch, memory_order_acquire);
+
+  for (ebr_thread_t *t = ebr->threads; NULL != t; t = t->next) {
+    uint64_t state = atomic_load_explicit(&t->state, memory_order_acquire);
+    if ((state & ACTIVE) && state >> 1 != epoch) return;
+  }
+
+  atomic_compare_exchange_strong_explicit(&ebr->epoch, &epoch, epoch + 1, memory_order_acq_rel,
+                                          memory_order_relaxed);
+}
+
+/* Copies the published hazard pointers into thr->scratch. Call with the lock */
+static size_t gatherhazards(ebr_thread_t *thr) {
+  size_t n = 0;
+
+  for (ebr_thread_t *t = thr->ebr->threads; NULL != t; t = t->next) {
+    for (size_t i = 0; i < EBR_HAZARDS; i++) {
+      void *ptr = atomic_load_explicit(&t->hazards[i], memory_order_acquire);
+      if (NULL == ptr) continue;
+
+      if (n == thr->scratchcap) {
+        size_t capacity = thr->scratchcap ? thr->scratchcap * 2 : EBR_HAZARDS * 4;
+        void **scratch = realloc(thr->scratch, capacity * sizeof *scratch);
+        if (NULL == scratch) return SIZE_MAX;
+
+        thr->scratch = scratch;
+        thr->scratchcap = capacity;
+      }
+      thr->scratch[n++] = ptr;
+    }
+  }
+
+  return n;
+}
+
+static int ishazard(ebr_thread_t *thr, size_t nhazards, void *ptr) {
+  for (size_t i = 0; i < nhazards; i++) {
+    if (thr->scratch[i] == ptr) return 1;
+  }
+  return 0;
+}
+
+/* Frees a node that could not be deferred, once it is safe. Much slower than ebr_collect */
+static void waitandfree(ebr_thread_t *thr, void *ptr, free_fn item_free, uint64_t retired) {
+  ebr_t *ebr = thr->ebr;
+  if (thr->depth > 0) PANIC("Cannot wait for reclamation in a critical section, PANICING(exiting)\n");
+
+  for (int safe = 0; !safe;) {
+    pthread_mutex_lock(&ebr->lock);
+    tryadvance(ebr);
+    safe = retired + 2 <= atomic_load_explicit(&ebr->epoch, memory_order_acquire);
+    for (ebr_thread_t *t = ebr->threads; safe && NULL != t; t = t->next) {
+      for (size_t i = 0; i < EBR_HAZARDS; i++) {
+        if (atomic_load_explicit(&t->hazards[i], memory_order_acquire) == ptr) safe = 0;
+      }
+    }
+    pthread_mutex_unlock(&ebr->lock);
+
+    if (!safe) sched_yield();
+  }
+
+  item_free(ptr);
+}
+
+
+ebr_t *ebr_create(void) {
+  ebr_t *ebr = aligned_alloc(CACHE_LINE, sizeof *ebr);
+  if (NULL == ebr) {
+    pr_error("Failed to allocate memory for reclamation domain\n");
+    return NULL;
+  }
+
+  atomic_init(&ebr->epoch, 0);
+  pthread_mutex_init(&ebr->lock, NULL);
+  ebr->threads = NULL;
+  ebr->orphans = (limbo_t) {NULL, 0, 0};
+  atomic_init(&ebr->norphans, 0);
+  return ebr;
+}
+
+void ebr_destroy(ebr_t *ebr) {
+  if (NULL == ebr) return;
+
+  if (NULL != ebr->threads) pr_warn("Destroying reclamation domain with registered threads\n");
+  limbo_freeall(&ebr->orphans);
+  pthread_mutex_destroy(&ebr->lock);
+  free(ebr);
+}
+
+ebr_thread_t *ebr_register(ebr_t *ebr) {
+  if (NULL == ebr) {
+    pr_error("Reclamation domain not given\n");
+    return NULL;
+  }
+
+  ebr_thread_t *thr = aligned_alloc(CACHE_LINE, sizeof *thr);
+  if (NULL == thr) {
+    pr_error("Failed to allocate reclamation thread record\n");
+    return NULL;
+  }
+
+  atomic_init(&thr->state, 0);
+  for (size_t i = 0; i < EBR_HAZARDS; i++) {
+    atomic_init(&thr->hazards[i], NULL);
+  }
+  thr->ebr = ebr;
+  thr->depth = 0;
+  thr->limbo = (limbo_t) {NULL, 0, 0};
+  thr->scratch = NULL;
+  thr->scratchcap = 0;
+
+  pthread_mutex_lock(&ebr->lock);
+  thr->next = ebr->threads;
+  ebr->threads = thr;
+  pthread_mutex_unlock(&ebr->lock);
+
+  return thr;
+}
+
+void ebr_unregister(ebr_thread_t *thr) {
+  if (NULL == thr) return;
+
+  ebr_t *ebr = thr->ebr;
+  if (thr->depth > 0) pr_warn("Unregistering a thread inside a critical section\n");
+
+  ebr_collect(thr);
+
+  pthread_mutex_lock(&ebr->lock);
+  ebr_thread_t **pp = &ebr->threads;
+  while (*pp != thr) {
+    pp = &(*pp)->next;
+  }
+  *pp = thr->next;
+
+  // whatever is still waiting is left to the other threads, or to ebr_destroy
+  for (size_t i = 0; i < thr->limbo.length; i++) {
+    if (limbo_push(&ebr->orphans, thr->limbo.items[i]) < 0) {
+      PANIC("Failed to hand over retired nodes, PANICING(exiting)\n");
+    }
+  }
+  atomic_store_explicit(&ebr->norphans, ebr->orphans.length, memory_order_relaxed);
+  pthread_mutex_unlock(&ebr->lock);
+
+  free(thr->limbo.items);
+  free(thr->scratch);
+  free(thr);
+}
+
+void ebr_enter(ebr_thread_t *thr) {
+  if (thr->depth++ > 0) return;
+
+  uint64_t epoch = atomic_load_explicit(&thr->ebr->epoch, memory_order_relaxed);
+  // seq_cst, so that reads of the structure cannot move before the announcement
+  atomic_exchange_explicit(&thr->state, epoch << 1 | ACTIVE, memory_order_seq_cst);
+}
+
+void ebr_exit(ebr_thread_t *thr) {
+  if (--thr->depth > 0) return;
+
+  atomic_store_explicit(&thr->state, 0, memory_order_release);
+}
+
+void ebr_retire(ebr_thread_t *thr, void *ptr, free_fn item_free) {
+  if (NULL == ptr) return;
+
+  // the epoch must be read after the unlink of ptr is visible
+  atomic_thread_fence(memory_order_seq_cst);
+  uint64_t epoch = atomic_load_explicit(&thr->ebr->epoch, memory_order_relaxed);
+
+  if (limbo_push(&thr->limbo, (retired_t) {ptr, item_free, epoch}) < 0) {
+    pr_warn("Failed to allocate retire record, waiting\n");
+    waitandfree(thr, ptr, item_free, epoch);
+    return;
+  }
+
+  if (0 == thr->limbo.length % EBR_RETIRE_BATCH) ebr_collect(thr);
+}
+
+size_t ebr_collect(ebr_thread_t *thr) {
+  ebr_t *ebr = thr->ebr;
+  limbo_t *limbo = &thr->limbo;
+
+  pthread_mutex_lock(&ebr->lock);
+
+  // adopt the nodes of unregistered threads
+  if (atomic_load_explicit(&ebr->norphans, memory_order_relaxed) > 0) {
+    limbo_t *orphans = &ebr->orphans;
+    size_t n = 0;
+    while (n < orphans->length && limbo_push(limbo, orphans->items[n]) == 0) {
+      n++;
+    }
+    memmove(orphans->items, orphans->items + n, (orphans->length - n) * sizeof *orphans->items);
+    orphans->length -= n;
+    atomic_store_explicit(&ebr->norphans, orphans->length, memory_order_relaxed);
+  }
+
+  tryadvance(ebr);
+  uint64_t epoch = atomic_load_explicit(&ebr->epoch, memory_order_acquire);
+  size_t nhazards = gatherhazards(thr);
+
+  pthread_mutex_unlock(&ebr->lock);
+
+  // without the hazard pointers nothing can be proven unprotected
+  if (SIZE_MAX == nhazards) return limbo->length;
+
+  size_t kept = 0;
+  for (size_t i = 0; i < limbo->length; i++) {
+    retired_t *r = &limbo->items[i];
+    if (r->epoch + 2 <= epoch && !ishazard(thr, nhazards, r->ptr)) {
+      r->item_free(r->ptr);
+    } else {
+      limbo->items[kept++] = *r;
+    }
+  }
+  limbo->length = kept;
+
+  return kept;
+}
+
+void ebr_protect(ebr_thread_t *thr, size_t slot, void *ptr) {
+  // seq_cst, so that the caller's re-read of the link cannot move before the publication
+  atomic_store_explicit(&thr->hazards[slot], ptr, memory_order_seq_cst);
+}
+
+void ebr_unprotect(ebr_thread_t *thr, size_t slot) {
+  atomic_store_explicit(&thr->hazards[slot], NULL, memory_order_release);
+}
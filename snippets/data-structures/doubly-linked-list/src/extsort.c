@@ -0,0 +1,505 @@
+#include "defs.h"
+#include "extsort.h"
+#include "list.h"
+#include "printing.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* records are stored as a 32-bit length followed by the encoded item */
+#define LEN_SIZE sizeof(uint32_t)
+
+/* size of the write buffer used when spilling a run */
+#define WRITE_IOBUF (1024 * 1024)
+
+typedef struct reader reader_t;
+struct reader {
+  FILE *file;
+  uint8_t *buf;
+  size_t cap;
+  size_t pos;
+  size_t len;
+  void *item; /* current head of the run, NULL once the run is exhausted */
+};
+
+typedef struct writer writer_t;
+struct writer {
+  FILE *file;
+  uint8_t *buf;
+  size_t cap;
+  size_t len;
+};
+
+struct extsort {
+  cmp_fn cmpfn;
+  extsort_codec_t codec;
+  free_fn item_free;
+  size_t budget;
+  size_t used;
+  list_t *pending;
+
+  FILE **runs;
+  size_t nruns;
+  size_t runcap;
+  size_t nspilled;
+
+  /* merge state, set up by extsort_finish */
+  reader_t *readers;
+  size_t *tree;
+  size_t k;
+  int finished;
+  int error;   /* a run could not be read back, and items were lost */
+};
+
+
+extsort_t *extsort_create(cmp_fn cmpfn, const extsort_codec_t *codec, size_t budget,
+                          free_fn item_free) {
+  if (NULL == cmpfn || NULL == codec || NULL == codec->encode || NULL == codec->decode ||
+      NULL == item_free) {
+    pr_error("Comparison function, codec and item free function must be given\n");
+    return NULL;
+  }
+
+  extsort_t *es = calloc(1, sizeof *es);
+  if (NULL == es) {
+    pr_error("Failed to allocate memory for external sorter\n");
+    return NULL;
+  }
+
+  es->pending = list_create(cmpfn);
+  if (NULL == es->pending) {
+    free(es);
+    return NULL;
+  }
+
+  es->cmpfn = cmpfn;
+  es->codec = *codec;
+  es->item_free = item_free;
+  es->budget = budget;
+
+  return es;
+}
+
+
+/* ---- run files ---- */
+
+
+static int addrun(extsort_t *es, FILE *file) {
+  if (es->nruns == es->runcap) {
+    size_t cap = es->runcap ? es->runcap * 2 : 16;
+    FILE **runs = realloc(es->runs, cap * sizeof *runs);
+    if (NULL == runs) {
+      pr_error("Failed to grow run table\n");
+      return -1;
+    }
+    es->runs = runs;
+    es->runcap = cap;
+  }
+
+  es->runs[es->nruns++] = file;
+  es->nspilled += 1;
+  return 0;
+}
+
+static FILE *newrunfile(void) {
+  FILE *file = tmpfile();
+  if (NULL == file) {
+    pr_error("Failed to create temporary run file\n");
+    return NULL;
+  }
+
+  /* readers and writers do their own large buffered I/O */
+  setvbuf(file, NULL, _IONBF, 0);
+  return file;
+}
+
+static int writer_flush(writer_t *w) {
+  if (w->len > 0 && fwrite(w->buf, 1, w->len, w->file) != w->len) {
+    pr_error("Failed to write run file\n");
+    return -1;
+  }
+  w->len = 0;
+  return 0;
+}
+
+static int writer_put(extsort_t *es, writer_t *w, const void *item) {
+  if (w->cap - w->len < LEN_SIZE && writer_flush(w) < 0) return -1;
+
+  /* try to encode directly into the remaining buffer space */
+  size_t avail = w->cap - w->len - LEN_SIZE;
+  size_t need = es->codec.encode(item, w->buf + w->len + LEN_SIZE, avail);
+
+  if (need > UINT32_MAX) {
+    pr_error("Encoded item is too large (%zu bytes)\n", need);
+    return -1;
+  }
+
+  if (need > avail) {
+    if (writer_flush(w) < 0) return -1;
+
+    if (LEN_SIZE + need > w->cap) {
+      uint8_t *buf = realloc(w->buf, LEN_SIZE + need);
+      if (NULL == buf) {
+        pr_error("Failed to grow write buffer\n");
+        return -1;
+      }
+      w->buf = buf;
+      w->cap = LEN_SIZE + need;
+    }
+    es->codec.encode(item, w->buf + LEN_SIZE, need);
+  }
+
+  uint32_t len32 = (uint32_t) need;
+  memcpy(w->buf + w->len, &len32, LEN_SIZE);
+  w->len += LEN_SIZE + need;
+
+  return 0;
+}
+
+/* Ensures `n` bytes are buffered at the read position. Returns 0 on success, 1 on EOF */
+static int reader_fill(reader_t *r, size_t n) {
+  if (r->len - r->pos >= n) return 0;
+
+  if (r->pos > 0) {
+    memmove(r->buf, r->buf + r->pos, r->len - r->pos);
+    r->len -= r->pos;
+    r->pos = 0;
+  }
+
+  if (n > r->cap) {
+    uint8_t *buf = realloc(r->buf, n);
+    if (NULL == buf) {
+      pr_error("Failed to grow read buffer\n");
+      return -1;
+    }
+    r->buf = buf;
+    r->cap = n;
+  }
+
+  while (r->len < n) {
+    size_t got = fread(r->buf + r->len, 1, r->cap - r->len, r->file);
+    if (0 == got) {
+      if (ferror(r->file)) {
+        pr_error("Failed to read run file\n");
+        return -1;
+      }
+      return 1;
+    }
+    r->len += got;
+  }
+
+  return 0;
+}
+
+/* Decodes the next record of the run into `r->item`, or sets it to NULL at the end of the run */
+static int reader_advance(extsort_t *es, reader_t *r) {
+  r->item = NULL;
+
+  int rc = reader_fill(r, LEN_SIZE);
+  if (rc < 0) return -1;
+  if (rc > 0) {
+    // only a clean end of run if no partial length prefix is left over
+    if (r->len > r->pos) {
+      pr_error("Run file is truncated\n");
+      return -1;
+    }
+    return 0;
+  }
+
+  uint32_t len32;
+  memcpy(&len32, r->buf + r->pos, LEN_SIZE);
+
+  if (0 != reader_fill(r, LEN_SIZE + len32)) {
+    pr_error("Run file is truncated\n");
+    return -1;
+  }
+
+  r->item = es->codec.decode(r->buf + r->pos + LEN_SIZE, len32);
+  if (NULL == r->item) {
+    pr_error("Failed to decode item\n");
+    return -1;
+  }
+  r->pos += LEN_SIZE + len32;
+
+  return 0;
+}
+
+/* Sorts the pending items and writes them to a new run */
+static int spill(extsort_t *es) {
+  list_t *run = es->pending;
+  if (0 == list_length(run)) return 0;
+
+  FILE *file = newrunfile();
+  if (NULL == file) return -1;
+
+  writer_t w = {.file = file, .buf = malloc(WRITE_IOBUF), .cap = WRITE_IOBUF, .len = 0};
+  if (NULL == w.buf) {
+    pr_error("Failed to allocate write buffer\n");
+    fclose(file);
+    return -1;
+  }
+
+  list_sort(run);
+
+  int rc = 0;
+  while (0 == rc && list_length(run) > 0) {
+    void *item = list_popfirst(run);
+    rc = writer_put(es, &w, item);
+    es->item_free(item);
+  }
+
+  if (0 == rc) rc = writer_flush(&w);
+  free(w.buf);
+
+  if (0 == rc) {
+    rewind(file);
+    rc = addrun(es, file);
+  }
+  if (0 != rc) {
+    fclose(file);
+    return -1;
+  }
+
+  es->used = 0;
+  return 0;
+}
+
+
+/* ---- k-way merge with a loser tree ---- */
+
+
+/*
+ * The tree has k internal nodes. tree[0] holds the overall winner, and tree[1..k-1]
+ * hold the loser of the match played at that node. Leaf i is run i, and its parent
+ * is node (i + k) / 2. Index k is a virtual leaf that wins against everything, used
+ * to seed the tree during construction. Exhausted runs lose against everything.
+ */
+
+static int beats(extsort_t *es, size_t a, size_t b) {
+  if (a == es->k) return 1;
+  if (b == es->k) return 0;
+
+  void *x = es->readers[a].item;
+  void *y = es->readers[b].item;
+  if (NULL == x) return 0;
+  if (NULL == y) return 1;
+
+  int c = es->cmpfn(x, y);
+  return c < 0 || (c == 0 && a < b);
+}
+
+/* Replays the matches from `leaf` to the root after the head of its run changed */
+static void replay(extsort_t *es, size_t leaf) {
+  size_t winner = leaf;
+
+  for (size_t t = (leaf + es->k) / 2; t > 0; t /= 2) {
+    if (beats(es, es->tree[t], winner)) {
+      size_t loser = winner;
+      winner = es->tree[t];
+      es->tree[t] = loser;
+    }
+  }
+
+  es->tree[0] = winner;
+}
+
+static void merge_close(extsort_t *es) {
+  for (size_t i = 0; i < es->k; i++) {
+    reader_t *r = &es->readers[i];
+    if (NULL != r->item) es->item_free(r->item);
+    free(r->buf);
+    if (NULL != r->file) fclose(r->file);
+  }
+
+  free(es->readers);
+  free(es->tree);
+  es->readers = NULL;
+  es->tree = NULL;
+  es->k = 0;
+}
+
+/* Opens the first k runs for merging. The merge takes ownership of their files */
+static int merge_open(extsort_t *es, size_t k) {
+  size_t bufsize = es->budget / (k + 1);
+  if (bufsize < EXTSORT_MIN_IOBUF) bufsize = EXTSORT_MIN_IOBUF;
+
+  es->readers = calloc(k, sizeof *es->readers);
+  es->tree = malloc(k * sizeof *es->tree);
+  if (NULL == es->readers || NULL == es->tree) {
+    pr_error("Failed to allocate merge state\n");
+    free(es->readers);
+    free(es->tree);
+    es->readers = NULL;
+    es->tree = NULL;
+    return -1;
+  }
+
+  es->k = k;
+  for (size_t i = 0; i < k; i++) {
+    es->readers[i].file = es->runs[i];
+  }
+  memmove(es->runs, es->runs + k, (es->nruns - k) * sizeof *es->runs);
+  es->nruns -= k;
+
+  for (size_t i = 0; i < k; i++) {
+    reader_t *r = &es->readers[i];
+    r->buf = malloc(bufsize);
+    r->cap = bufsize;
+    if (NULL == r->buf || reader_advance(es, r) < 0) {
+      if (NULL != r->buf) es->error = 1;
+      merge_close(es);
+      return -1;
+    }
+  }
+
+  for (size_t i = 0; i < k; i++) {
+    es->tree[i] = k;
+  }
+  for (size_t leaf = k; leaf-- > 0;) {
+    replay(es, leaf);
+  }
+
+  return 0;
+}
+
+static void *merge_pop(extsort_t *es) {
+  if (0 == es->k || es->error) return NULL;
+
+  size_t winner = es->tree[0];
+  reader_t *r = &es->readers[winner];
+  void *item = r->item;
+  if (NULL == item) return NULL;
+
+  /* the rest of the run is lost on a read error, which stops the merge */
+  if (reader_advance(es, r) < 0) es->error = 1;
+  replay(es, winner);
+
+  return item;
+}
+
+/* Merges the first k runs into a single new run at the end of the run table */
+static int merge_pass(extsort_t *es, size_t k) {
+  FILE *file = newrunfile();
+  if (NULL == file) return -1;
+
+  writer_t w = {.file = file, .buf = malloc(WRITE_IOBUF), .cap = WRITE_IOBUF, .len = 0};
+  if (NULL == w.buf || merge_open(es, k) < 0) {
+    free(w.buf);
+    fclose(file);
+    return -1;
+  }
+
+  int rc = 0;
+  void *item;
+  while (0 == rc && NULL != (item = merge_pop(es))) {
+    rc = writer_put(es, &w, item);
+    es->item_free(item);
+  }
+
+  if (0 == rc && es->error) rc = -1;
+  if (0 == rc) rc = writer_flush(&w);
+  free(w.buf);
+  merge_close(es);
+
+  if (0 == rc) {
+    rewind(file);
+    rc = addrun(es, file);
+  }
+  if (0 != rc) {
+    fclose(file);
+    return -1;
+  }
+
+  return 0;
+}
+
+
+/* ---- public interface ---- */
+
+
+void extsort_destroy(extsort_t *es) {
+  if (NULL == es) return;
+
+  merge_close(es);
+  for (size_t i = 0; i < es->nruns; i++) {
+    fclose(es->runs[i]);
+  }
+  free(es->runs);
+  list_destroy(es->pending, es->item_free);
+  free(es);
+}
+
+int extsort_push(extsort_t *es, void *item) {
+  if (NULL == es || NULL == item) {
+    pr_error("Sorter parameter and item parameter not given\n");
+    return -1;
+  }
+  if (es->finished) {
+    pr_error("Cannot push to a finished sorter\n");
+    return -1;
+  }
+
+  size_t size = es->codec.encode(item, NULL, 0) + EXTSORT_ITEM_OVERHEAD;
+
+  if (es->used + size > es->budget && list_length(es->pending) > 0) {
+    if (spill(es) < 0) return -1;
+  }
+
+  if (list_addlast(es->pending, item) < 0) return -1;
+  es->used += size;
+
+  return 0;
+}
+
+int extsort_finish(extsort_t *es) {
+  if (NULL == es || es->finished) {
+    pr_error("Sorter not given or already finished\n");
+    return -1;
+  }
+  es->finished = 1;
+
+  /* everything fit in memory */
+  if (0 == es->nruns) {
+    if (list_length(es->pending) > 0) list_sort(es->pending);
+    return 0;
+  }
+
+  if (spill(es) < 0) return -1;
+
+  size_t fanin = es->budget / EXTSORT_MIN_IOBUF;
+  if (fanin < 2) fanin = 2;
+
+  /* merge the oldest runs until the rest can be merged in a single pass. The first
+   * pass merges only as many runs as needed to make the remaining passes full. */
+  while (es->nruns > fanin) {
+    size_t k = es->nruns - fanin + 1;
+    if (k > fanin) k = fanin;
+    if (merge_pass(es, k) < 0) return -1;
+  }
+
+  return merge_open(es, es->nruns);
+}
+
+int extsort_hasnext(extsort_t *es) {
+  if (NULL == es || !es->finished) return 0;
+  if (0 == es->k) return list_length(es->pending) > 0;
+
+  return !es->error && NULL != es->readers[es->tree[0]].item;
+}
+
+void *extsort_next(extsort_t *es) {
+  if (NULL == es || !es->finished) return NULL;
+
+  if (0 == es->k) {
+    if (0 == list_length(es->pending)) return NULL;
+    return list_popfirst(es->pending);
+  }
+
+  return merge_pop(es);
+}
+
+size_t extsort_runs(extsort_t *es) { return es->nspilled; }
+
+int extsort_error(extsort_t *es) { return es->error; }
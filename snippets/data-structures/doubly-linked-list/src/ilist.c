@@ -0,0 +1,361 @@
+#include "alloc.h"
+#include "defs.h"
+#include "ilist.h"
+#include "printing.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define NIL UINT32_MAX
+#define ILIST_MINCAP 16
+
+
+typedef struct inode {
+  uint32_t next;
+  uint32_t prev;
+  void *item;
+} inode_t;
+
+_Static_assert(sizeof(inode_t) <= 16, "index list nodes must fit in 16 bytes");
+
+/*
+ * Nodes [0, used) of the array have been handed out. Freed nodes among them are chained
+ * through `next`, starting at `freelist`.
+ */
+struct ilist {
+  inode_t *nodes;
+  size_t capacity;
+  size_t used;
+  size_t length;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t freelist;
+  cmp_fn cmpfn;
+  allocator_t allocator;
+  memstat_t mem;
+};
+
+struct ilist_iter {
+  ilist_t *list;
+  uint32_t node;
+};
+
+
+static uint32_t newnode(ilist_t *list, void *item) {
+  uint32_t index;
+
+  if (NIL != list->freelist) {
+    index = list->freelist;
+    list->freelist = list->nodes[index].next;
+  } else {
+    if (list->used == list->capacity) {
+      if (list->capacity >= ILIST_MAXLEN) {
+        pr_error("Index list is full\n");
+        return NIL;
+      }
+
+      size_t capacity = list->capacity ? list->capacity * 2 : ILIST_MINCAP;
+      if (capacity > ILIST_MAXLEN) capacity = ILIST_MAXLEN;
+
+      inode_t *nodes = mem_realloc(&list->allocator, &list->mem, list->nodes,
+                                   list->capacity * sizeof *nodes, capacity * sizeof *nodes);
+      if (NULL == nodes) {
+        pr_error("Failed to grow index list to %zu nodes\n", capacity);
+        return NIL;
+      }
+      list->nodes = nodes;
+      list->capacity = capacity;
+    }
+    index = (uint32_t) list->used++;
+  }
+
+  list->nodes[index].next = NIL;
+  list->nodes[index].prev = NIL;
+  list->nodes[index].item = item;
+  return index;
+}
+
+static void freenode(ilist_t *list, uint32_t index) {
+  list->nodes[index].item = NULL;
+  list->nodes[index].next = list->freelist;
+  list->freelist = index;
+}
+
+/* Unlinks a node from the chain and frees it */
+static void *unlinknode(ilist_t *list, uint32_t index) {
+  inode_t *node = &list->nodes[index];
+  void *returnData = node->item;
+
+  if (NIL == node->prev) {
+    list->head = node->next;
+  } else {
+    list->nodes[node->prev].next = node->next;
+  }
+
+  if (NIL == node->next) {
+    list->tail = node->prev;
+  } else {
+    list->nodes[node->next].prev = node->prev;
+  }
+
+  freenode(list, index);
+  list->length -= 1;
+  return returnData;
+}
+
+
+ilist_t *ilist_create(cmp_fn cmpfn) { return ilist_create_with_allocator(cmpfn, NULL); }
+
+ilist_t *ilist_create_with_allocator(cmp_fn cmpfn, const allocator_t *allocator) {
+  if (NULL == cmpfn) {
+    pr_error("Failed compare function not given\n");
+    return NULL;
+  }
+  if (NULL == allocator) allocator = &stdlib_allocator;
+
+  ilist_t *list = allocator->alloc(allocator->ctx, sizeof *list);
+  if (NULL == list) {
+    pr_error("Failed to allocate memory for index list\n");
+    return NULL;
+  }
+
+  list->nodes = NULL;
+  list->capacity = 0;
+  list->used = 0;
+  list->length = 0;
+  list->head = NIL;
+  list->tail = NIL;
+  list->freelist = NIL;
+  list->cmpfn = cmpfn;
+  list->allocator = *allocator;
+  list->mem.inuse = sizeof *list;
+  list->mem.peak = sizeof *list;
+
+  return list;
+}
+
+void ilist_destroy(ilist_t *list, free_fn item_free) {
+  if (NULL == list) return;
+
+  if (NULL != item_free) {
+    for (uint32_t i = list->head; NIL != i; i = list->nodes[i].next) {
+      item_free(list->nodes[i].item);
+    }
+  }
+
+  mem_free(&list->allocator, &list->mem, list->nodes, list->capacity * sizeof *list->nodes);
+  allocator_t allocator = list->allocator;
+  allocator.free(allocator.ctx, list, sizeof *list);
+}
+
+size_t ilist_length(ilist_t *list) { return list->length; }
+
+void ilist_memstat(ilist_t *list, memstat_t *stat) { *stat = list->mem; }
+
+int ilist_addfirst(ilist_t *list, void *item) {
+  if (NULL == list || NULL == item) {
+    pr_error("List parameter and item parameter not given\n");
+    return -1;
+  }
+
+  uint32_t index = newnode(list, item);
+  if (NIL == index) return -1;
+
+  list->nodes[index].next = list->head;
+  if (NIL == list->head) {
+    list->tail = index;
+  } else {
+    list->nodes[list->head].prev = index;
+  }
+  list->head = index;
+  list->length += 1;
+
+  return 0;
+}
+
+int ilist_addlast(ilist_t *list, void *item) {
+  if (NULL == list || NULL == item) {
+    pr_error("List parameter and item parameter not given\n");
+    return -1;
+  }
+
+  uint32_t index = newnode(list, item);
+  if (NIL == index) return -1;
+
+  list->nodes[index].prev = list->tail;
+  if (NIL == list->tail) {
+    list->head = index;
+  } else {
+    list->nodes[list->tail].next = index;
+  }
+  list->tail = index;
+  list->length += 1;
+
+  return 0;
+}
+
+void *ilist_popfirst(ilist_t *list) {
+  if (NULL == list || 0 == list->length) PANIC("List is empty, PANICING(exiting)\n");
+
+  return unlinknode(list, list->head);
+}
+
+void *ilist_poplast(ilist_t *list) {
+  if (NULL == list || 0 == list->length) PANIC("List is empty, PANICING(exiting)\n");
+
+  return unlinknode(list, list->tail);
+}
+
+void *ilist_remove(ilist_t *list, void *item) {
+  if (NULL == list || NULL == item) return NULL;
+
+  for (uint32_t i = list->head; NIL != i; i = list->nodes[i].next) {
+    if (list->cmpfn(list->nodes[i].item, item) == 0) return unlinknode(list, i);
+  }
+
+  return NULL;
+}
+
+int ilist_contains(ilist_t *list, void *item) {
+  for (uint32_t i = list->head; NIL != i; i = list->nodes[i].next) {
+    if (list->cmpfn(list->nodes[i].item, item) == 0) return 1;
+  }
+
+  return 0;
+}
+
+
+/* ---- mergesort, as in linkedlist.c but on indices ---- */
+
+
+/* Merges two sorted chains on their next links only. Returns the head of the merged chain */
+static uint32_t merge(inode_t *nodes, uint32_t a, uint32_t b, cmp_fn cmpfn) {
+  uint32_t head, tail;
+
+  if (cmpfn(nodes[a].item, nodes[b].item) <= 0) {
+    head = tail = a;
+    a = nodes[a].next;
+  } else {
+    head = tail = b;
+    b = nodes[b].next;
+  }
+
+  while (NIL != a && NIL != b) {
+    if (cmpfn(nodes[a].item, nodes[b].item) <= 0) {
+      nodes[tail].next = a;
+      tail = a;
+      a = nodes[a].next;
+    } else {
+      nodes[tail].next = b;
+      tail = b;
+      b = nodes[b].next;
+    }
+  }
+
+  nodes[tail].next = NIL != a ? a : b;
+  return head;
+}
+
+/* Cuts a chain in half, and returns the head of the second half */
+static uint32_t splitchain(inode_t *nodes, uint32_t head) {
+  uint32_t slow = head;
+  uint32_t fast = nodes[head].next;
+
+  while (NIL != fast && NIL != nodes[fast].next) {
+    slow = nodes[slow].next;
+    fast = nodes[nodes[fast].next].next;
+  }
+
+  uint32_t half = nodes[slow].next;
+  nodes[slow].next = NIL;
+  return half;
+}
+
+static uint32_t mergesort_(inode_t *nodes, uint32_t head, cmp_fn cmpfn) {
+  if (NIL == head || NIL == nodes[head].next) return head;
+
+  uint32_t half = splitchain(nodes, head);
+  head = mergesort_(nodes, head, cmpfn);
+  half = mergesort_(nodes, half, cmpfn);
+  return merge(nodes, head, half, cmpfn);
+}
+
+void ilist_sort(ilist_t *list) {
+  list->head = mergesort_(list->nodes, list->head, list->cmpfn);
+
+  /* fix the tail and prev links */
+  uint32_t prev = NIL;
+  for (uint32_t i = list->head; NIL != i; i = list->nodes[i].next) {
+    list->nodes[i].prev = prev;
+    prev = i;
+  }
+  list->tail = prev;
+}
+
+int ilist_compact(ilist_t *list) {
+  size_t capacity = list->length > ILIST_MINCAP ? list->length : ILIST_MINCAP;
+  inode_t *nodes = mem_alloc(&list->allocator, &list->mem, capacity * sizeof *nodes);
+  if (NULL == nodes) {
+    pr_error("Failed to allocate %zu nodes to compact index list\n", capacity);
+    return -1;
+  }
+
+  // node k of the traversal moves to index k
+  uint32_t k = 0;
+  for (uint32_t i = list->head; NIL != i; i = list->nodes[i].next, k++) {
+    nodes[k].item = list->nodes[i].item;
+    nodes[k].prev = k - 1;
+    nodes[k].next = k + 1;
+  }
+  if (k > 0) {
+    nodes[0].prev = NIL;
+    nodes[k - 1].next = NIL;
+  }
+
+  mem_free(&list->allocator, &list->mem, list->nodes, list->capacity * sizeof *list->nodes);
+  list->nodes = nodes;
+  list->capacity = capacity;
+  list->used = k;
+  list->freelist = NIL;
+  list->head = k > 0 ? 0 : NIL;
+  list->tail = k > 0 ? k - 1 : NIL;
+
+  return 0;
+}
+
+
+ilist_iter_t *ilist_createiter(ilist_t *list) {
+  if (NULL == list) {
+    pr_error("List parameter not given\n");
+    return NULL;
+  }
+
+  // iterators stay on malloc, so they can outlive the list and its allocator
+  ilist_iter_t *iter = malloc(sizeof *iter);
+  if (NULL == iter) {
+    pr_error("Failed to allocate list iter\n");
+    return NULL;
+  }
+
+  iter->list = list;
+  iter->node = list->head;
+  return iter;
+}
+
+void ilist_destroyiter(ilist_iter_t *iter) { free(iter); }
+
+int ilist_hasnext(ilist_iter_t *iter) { return NIL != iter->node; }
+
+void *ilist_next(ilist_iter_t *iter) {
+  if (NULL == iter || NIL == iter->node) return NULL;
+
+  inode_t *node = &iter->list->nodes[iter->node];
+  iter->node = node->next;
+  return node->item;
+}
+
+void ilist_resetiter(ilist_iter_t *iter) {
+  if (NULL == iter) return;
+
+  iter->node = iter->list->head;
+}
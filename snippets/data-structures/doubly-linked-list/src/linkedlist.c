@@ -1,9 +1,15 @@
+#include "alloc.h"
+#include "bloom.h"
 #include "defs.h"
 #include "list.h"
 #include "printing.h"
+#include "threadpool.h"
+#include "trace.h"
 
 #include <stdlib.h>
+#include <string.h>
 
+#define FILTER_MINCAP 64
 
 typedef struct lnode lnode_t;
 struct lnode {
@@ -17,6 +23,12 @@ struct list {
   lnode_t *tail;
   size_t length;
   cmp_fn cmpfn;
+  allocator_t allocator;
+  memstat_t mem;
+  bloom_t *filter;      /* nullable, see list_setfilter */
+  hash64_fn hashfn;
+  double fprate;
+  size_t filterroom;    /* adds left before the filter is over capacity */
 };
 
 struct list_iter {
@@ -25,9 +37,9 @@ struct list_iter {
 };
 
 
-static lnode_t *newnode(void *item) {
+static lnode_t *newnode(list_t *list, void *item) {
   lnode_t *newNode;
-  newNode = malloc(sizeof *newNode);
+  newNode = mem_alloc(&list->allocator, &list->mem, sizeof *newNode);
   if (NULL == newNode) {
     pr_error("Failed to allocate new node for linked list\n");
     return NULL; 
@@ -40,14 +52,78 @@ static lnode_t *newnode(void *item) {
   return newNode;
 }
 
-list_t *list_create(const cmp_fn cmpfn) {
+static void freenode(list_t *list, lnode_t *node) {
+  mem_free(&list->allocator, &list->mem, node, sizeof *node);
+}
+
+/* Replaces the filter with one sized for twice the current items, and adds them all */
+/*
+ * The filter allocates through the list's allocator and is charged to the list's memstat, so
+ * that the peak covers the list and filter together, including the overlap during a rebuild.
+ */
+static void *filteralloc(void *ctx, size_t size) {
+  list_t *list = ctx;
+  return mem_alloc(&list->allocator, &list->mem, size);
+}
+
+static void *filterrealloc(void *ctx, void *ptr, size_t oldsize, size_t newsize) {
+  list_t *list = ctx;
+  return mem_realloc(&list->allocator, &list->mem, ptr, oldsize, newsize);
+}
+
+static void filterfree(void *ctx, void *ptr, size_t size) {
+  list_t *list = ctx;
+  mem_free(&list->allocator, &list->mem, ptr, size);
+}
+
+static int rebuildfilter(list_t *list) {
+  size_t capacity = 2 * list->length > FILTER_MINCAP ? 2 * list->length : FILTER_MINCAP;
+  allocator_t charged = {filteralloc, filterrealloc, filterfree, list};
+  bloom_t *filter = bloom_create_with_allocator(list->hashfn, capacity, list->fprate, &charged);
+  if (NULL == filter) return -1;
+
+  for (lnode_t *node = list->head; NULL != node; node = node->next) {
+    bloom_add(filter, node->item);
+  }
+
+  bloom_destroy(list->filter);
+  list->filter = filter;
+  list->filterroom = capacity - list->length;
+  return 0;
+}
+
+/*
+ * Adds a newly linked item to the filter, if any. Removed items are never cleared from the
+ * filter, so once it has taken as many adds as it was sized for it is rebuilt from the list.
+ */
+static void filteradd(list_t *list, void *item) {
+  if (NULL == list->filter) return;
+
+  if (0 == list->filterroom) {
+    // the rebuilt filter holds every linked item, including this one
+    if (0 == rebuildfilter(list)) return;
+
+    // the old filter must still see the item, it just fills past its false-positive rate
+    pr_error("Failed to rebuild list filter\n");
+    bloom_add(list->filter, item);
+    return;
+  }
+
+  bloom_add(list->filter, item);
+  list->filterroom -= 1;
+}
+
+list_t *list_create(const cmp_fn cmpfn) { return list_create_with_allocator(cmpfn, NULL); }
+
+list_t *list_create_with_allocator(const cmp_fn cmpfn, const allocator_t *allocator) {
   if (NULL == cmpfn) {
     pr_error("Failed compare function not given %s, %d\n", __FILE__, __LINE__);
     return NULL;
   }
+  if (NULL == allocator) allocator = &stdlib_allocator;
 
   list_t *newList;
-  newList = malloc(sizeof *newList);
+  newList = allocator->alloc(allocator->ctx, sizeof *newList);
   if (NULL == newList) {
     pr_error("Failed to allocate memory for list %s, %d\n", __FILE__, __LINE__);
     return NULL;
@@ -56,6 +132,13 @@ list_t *list_create(const cmp_fn cmpfn) {
   newList->tail = NULL;
   newList->length = 0;
   newList->cmpfn = cmpfn;
+  newList->allocator = *allocator;
+  newList->mem.inuse = sizeof *newList;
+  newList->mem.peak = sizeof *newList;
+  newList->filter = NULL;
+  newList->hashfn = NULL;
+  newList->fprate = 0;
+  newList->filterroom = 0;
 
   return newList;
 }
@@ -72,17 +155,55 @@ void list_destroy(list_t *list, free_fn item_free) {
   while (NULL != iter) {
     lnode_t *next = iter->next;
     if (NULL != item_free) item_free(iter->item);
-    free(iter);
+    freenode(list, iter);
     iter = next; 
   }
 
   list->head = NULL;
   list->tail = NULL;
-  free(list);
+  bloom_destroy(list->filter);
+  allocator_t allocator = list->allocator;
+  allocator.free(allocator.ctx, list, sizeof *list);
 }
 
 size_t list_length(list_t *list) { return list->length; }
 
+void list_memstat(list_t *list, memstat_t *stat) { *stat = list->mem; }
+
+int list_setfilter(list_t *list, hash64_fn hashfn, double fprate) {
+  if (NULL == list) {
+    pr_error("List parameter not given\n");
+    return -1;
+  }
+
+  if (NULL == hashfn) {
+    bloom_destroy(list->filter);
+    list->filter = NULL;
+    list->hashfn = NULL;
+    return 0;
+  }
+
+  hash64_fn oldhashfn = list->hashfn;
+  double oldfprate = list->fprate;
+  list->hashfn = hashfn;
+  list->fprate = fprate;
+
+  if (rebuildfilter(list) < 0) {
+    list->hashfn = oldhashfn;
+    list->fprate = oldfprate;
+    return -1;
+  }
+
+  return 0;
+}
+
+int list_filterstats(list_t *list, bloom_stats_t *stats) {
+  if (NULL == list || NULL == list->filter) return -1;
+
+  bloom_stats(list->filter, stats);
+  return 0;
+}
+
 int list_addfirst(list_t *list, void *item) {
   if (NULL == list || NULL == item) {
     pr_error("List parameter and item parameter not given\n");
@@ -90,7 +211,8 @@ int list_addfirst(list_t *list, void *item) {
   }
 
   lnode_t *node;
-  node = newnode(item);
+  node = newnode(list, item);
+  if (NULL == node) return -1;
 
   // if the list is empty we set the new node as both head and tail
   if (0 == list->length) {
@@ -106,6 +228,7 @@ int list_addfirst(list_t *list, void *item) {
   }
 
   list->length += 1;
+  filteradd(list, item);
 
   return 0;
 }
@@ -117,7 +240,8 @@ int list_addlast(list_t *list, void *item) {
   }
 
   lnode_t *node;
-  node = newnode(item);
+  node = newnode(list, item);
+  if (NULL == node) return -1;
   
   // if the list is empty, we set the new node as both head and tail
   if (0 == list->length) {
@@ -133,12 +257,13 @@ int list_addlast(list_t *list, void *item) {
   }
   
   list->length += 1;
+  filteradd(list, item);
 
   return 0;
 }
 
 void *list_popfirst(list_t *list) {
-  if (NULL == list) PANIC("List is empty, PANICING(exiting)\n");
+  if (NULL == list || 0 == list->length) PANIC("List is empty, PANICING(exiting)\n");
   
   lnode_t *oldHead = list->head;
   void *returnData = list->head->item;
@@ -149,16 +274,18 @@ void *list_popfirst(list_t *list) {
   // if the list is now empty, we update the lists tail node accordingly
   if (NULL == list->head) {
     list->tail = NULL;
+  } else {
+    list->head->prev = NULL;
   }
 
-  free(oldHead);
+  freenode(list, oldHead);
   list->length -= 1;
 
   return returnData;
 }
 
 void *list_poplast(list_t *list) {
-  if (NULL == list) PANIC("List is empty, PANICING(exiting)\n");
+  if (NULL == list || 0 == list->length) PANIC("List is empty, PANICING(exiting)\n");
 
   lnode_t *oldTail = list->tail;
   void *returnData = list->tail->item;
@@ -168,15 +295,20 @@ void *list_poplast(list_t *list) {
   // if the list is now empty, we update the lists head node accordingly
   if (NULL == list->tail) {
     list->head = NULL;
+  } else {
+    list->tail->next = NULL;
   }
 
-  free(oldTail);
+  freenode(list, oldTail);
   list->length -= 1;
 
   return returnData;
 }
 
 int list_contains(list_t *list, void *item) {
+  // a definite miss in the filter saves walking the whole list
+  if (NULL != list->filter && !bloom_maycontain(list->filter, item)) return 0;
+
   lnode_t *iter = list->head;
 
   while (NULL != iter) {
@@ -189,7 +321,10 @@ int list_contains(list_t *list, void *item) {
 
 void *list_remove(list_t *list, void *item)
 {
+  TRACE_SCOPE("list_remove");
+
   if (NULL == list || NULL == item) return NULL;
+  if (NULL != list->filter && !bloom_maycontain(list->filter, item)) return NULL;
 
   lnode_t *iter = list->head;
   void* returnData = NULL;
@@ -215,7 +350,7 @@ void *list_remove(list_t *list, void *item)
         }
         
         list->length -= 1;
-        free(iter);
+        freenode(list, iter);
         return returnData;
       }
 
@@ -231,7 +366,7 @@ void *list_remove(list_t *list, void *item)
         }
 
         list->length -= 1;
-        free(iter);
+        freenode(list, iter);
         return returnData;
       }
 
@@ -240,7 +375,7 @@ void *list_remove(list_t *list, void *item)
       iter->next->prev = iter->prev;
       returnData = iter->item;
 
-      free(iter);
+      freenode(list, iter);
       list->length -= 1;
 
       return returnData;
@@ -341,6 +476,8 @@ static lnode_t *mergesort_(lnode_t *head, cmp_fn cmpfn){
 }
 
 void list_sort(list_t *list) {
+  TRACE_SCOPE("list_sort");
+
   /* Recursively sort the list */
   list->head = mergesort_(list->head, list->cmpfn);
 
@@ -360,6 +497,7 @@ list_iter_t *list_createiter(list_t *list) {
     return NULL;
   }
 
+  // iterators stay on malloc, so they can outlive the list and its allocator
   list_iter_t *iter;  
   iter = malloc(sizeof *iter);
   if (NULL == iter) {
@@ -373,7 +511,9 @@ list_iter_t *list_createiter(list_t *list) {
   return iter;
 }
 
-void list_destroyiter(list_iter_t *iter) { if (iter) free(iter); }
+void list_destroyiter(list_iter_t *iter) {
+  free(iter);
+}
 
 int list_hasnext(list_iter_t *iter) {
   if (NULL == iter->node) return 0;
@@ -403,3 +543,240 @@ void list_resetiter(list_iter_t *iter) {
   iter->node = iter->list->head;  
 }
 
+
+/* ---- parallel operations ---- */
+
+
+/* more segments than threads, so that stealing can even out uneven per-item costs */
+#define SEGMENTS_PER_THREAD 8
+
+enum parop { PAR_FOREACH, PAR_MAP, PAR_FILTER, PAR_REDUCE };
+
+typedef struct segment {
+  lnode_t *first;
+  size_t count;
+  void **out;           /* results of map and filter, in list order */
+  size_t nout;
+  void *acc;            /* partial result of reduce */
+} segment_t;
+
+typedef struct parjob {
+  threadpool_t *pool;
+  enum parop op;
+  segment_t *segs;
+  size_t nsegs;
+  union {
+    list_foreach_fn foreach;
+    list_map_fn map;
+    list_pred_fn pred;
+    list_reduce_fn fold;
+  } fn;
+  void *ctx;
+} parjob_t;
+
+typedef struct parrange {
+  parjob_t *job;
+  size_t lo;
+  size_t hi;
+} parrange_t;
+
+
+/*
+ * Cuts the node chain into segments of equal length, up to a few per thread, in one walk.
+ * Scratch memory of the parallel operations is not the list's own, so it uses malloc.
+ */
+static segment_t *segmentlist(list_t *list, threadpool_t *pool, size_t *nsegs) {
+  size_t n = threadpool_nthreads(pool) > 1 ? threadpool_nthreads(pool) * SEGMENTS_PER_THREAD : 1;
+  if (n > list->length) n = list->length;
+
+  segment_t *segs = calloc(n > 0 ? n : 1, sizeof *segs);
+  if (NULL == segs) {
+    pr_error("Failed to allocate list segments\n");
+    return NULL;
+  }
+
+  lnode_t *node = list->head;
+  for (size_t i = 0; i < n; i++) {
+    segs[i].first = node;
+    segs[i].count = list->length / n + (i < list->length % n);
+    for (size_t j = 0; j < segs[i].count; j++) {
+      node = node->next;
+    }
+  }
+
+  *nsegs = n;
+  return segs;
+}
+
+static void freesegments(segment_t *segs, size_t nsegs) {
+  for (size_t i = 0; i < nsegs; i++) {
+    free(segs[i].out);
+  }
+  free(segs);
+}
+
+static void runsegment(parjob_t *job, segment_t *seg) {
+  lnode_t *node = seg->first;
+
+  for (size_t i = 0; i < seg->count; i++, node = node->next) {
+    switch (job->op) {
+      case PAR_FOREACH:
+        job->fn.foreach(node->item, job->ctx);
+        break;
+      case PAR_MAP:
+        seg->out[seg->nout++] = job->fn.map(node->item, job->ctx);
+        break;
+      case PAR_FILTER:
+        if (job->fn.pred(node->item, job->ctx)) seg->out[seg->nout++] = node->item;
+        break;
+      case PAR_REDUCE:
+        job->fn.fold(seg->acc, node->item, job->ctx);
+        break;
+    }
+  }
+}
+
+/* Runs segments [lo, hi), spawning the upper half and running the lower half until one is left */
+static void runrange(void *arg) {
+  parrange_t *range = arg;
+  parjob_t *job = range->job;
+
+  if (range->hi - range->lo <= 1) {
+    if (range->hi > range->lo) runsegment(job, &job->segs[range->lo]);
+    return;
+  }
+
+  size_t mid = range->lo + (range->hi - range->lo) / 2;
+  parrange_t upper = {job, mid, range->hi};
+  parrange_t lower = {job, range->lo, mid};
+  threadpool_task_t task = THREADPOOL_TASK(runrange, &upper);
+
+  threadpool_spawn(job->pool, &task);
+  runrange(&lower);
+  threadpool_join(job->pool, &task);
+}
+
+static void runjob(parjob_t *job) {
+  parrange_t range = {job, 0, job->nsegs};
+  threadpool_run(job->pool, runrange, &range);
+}
+
+/* map and filter: gives every segment room for all of its results */
+static int allocout(segment_t *segs, size_t nsegs) {
+  for (size_t i = 0; i < nsegs; i++) {
+    segs[i].out = malloc(segs[i].count * sizeof *segs[i].out);
+    if (NULL == segs[i].out) {
+      pr_error("Failed to allocate list segment results\n");
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+/* map and filter: appends the results of all segments to a new list, in order */
+static list_t *collect(list_t *list, cmp_fn cmpfn, segment_t *segs, size_t nsegs) {
+  list_t *result = list_create_with_allocator(cmpfn, &list->allocator);
+  if (NULL == result) return NULL;
+
+  for (size_t i = 0; i < nsegs; i++) {
+    for (size_t j = 0; j < segs[i].nout; j++) {
+      if (list_addlast(result, segs[i].out[j]) < 0) {
+        list_destroy(result, NULL);
+        return NULL;
+      }
+    }
+  }
+
+  return result;
+}
+
+int list_foreach(threadpool_t *pool, list_t *list, list_foreach_fn fn, void *ctx) {
+  if (NULL == list || NULL == fn) {
+    pr_error("List parameter and function parameter not given\n");
+    return -1;
+  }
+
+  parjob_t job = {pool, PAR_FOREACH, NULL, 0, {.foreach = fn}, ctx};
+  job.segs = segmentlist(list, pool, &job.nsegs);
+  if (NULL == job.segs) return -1;
+
+  runjob(&job);
+  freesegments(job.segs, job.nsegs);
+  return 0;
+}
+
+list_t *list_map(threadpool_t *pool, list_t *list, list_map_fn fn, void *ctx, cmp_fn cmpfn) {
+  if (NULL == list || NULL == fn) {
+    pr_error("List parameter and function parameter not given\n");
+    return NULL;
+  }
+
+  parjob_t job = {pool, PAR_MAP, NULL, 0, {.map = fn}, ctx};
+  job.segs = segmentlist(list, pool, &job.nsegs);
+  if (NULL == job.segs) return NULL;
+
+  list_t *result = NULL;
+  if (allocout(job.segs, job.nsegs) == 0) {
+    runjob(&job);
+    result = collect(list, cmpfn, job.segs, job.nsegs);
+  }
+
+  freesegments(job.segs, job.nsegs);
+  return result;
+}
+
+list_t *list_filter(threadpool_t *pool, list_t *list, list_pred_fn pred, void *ctx) {
+  if (NULL == list || NULL == pred) {
+    pr_error("List parameter and function parameter not given\n");
+    return NULL;
+  }
+
+  parjob_t job = {pool, PAR_FILTER, NULL, 0, {.pred = pred}, ctx};
+  job.segs = segmentlist(list, pool, &job.nsegs);
+  if (NULL == job.segs) return NULL;
+
+  list_t *result = NULL;
+  if (allocout(job.segs, job.nsegs) == 0) {
+    runjob(&job);
+    result = collect(list, list->cmpfn, job.segs, job.nsegs);
+  }
+
+  freesegments(job.segs, job.nsegs);
+  return result;
+}
+
+int list_reduce(threadpool_t *pool, list_t *list, list_reduce_fn fold, list_reduce_fn combine,
+                void *acc, size_t accsize, void *ctx) {
+  if (NULL == list || NULL == fold || NULL == combine || NULL == acc) {
+    pr_error("List parameter, function parameters and accumulator not given\n");
+    return -1;
+  }
+
+  parjob_t job = {pool, PAR_REDUCE, NULL, 0, {.fold = fold}, ctx};
+  job.segs = segmentlist(list, pool, &job.nsegs);
+  if (NULL == job.segs) return -1;
+
+  // every segment starts from a copy of the identity in `acc`
+  char *accs = malloc(job.nsegs * accsize + 1);
+  if (NULL == accs) {
+    pr_error("Failed to allocate list reduce accumulators\n");
+    freesegments(job.segs, job.nsegs);
+    return -1;
+  }
+  for (size_t i = 0; i < job.nsegs; i++) {
+    job.segs[i].acc = accs + i * accsize;
+    memcpy(job.segs[i].acc, acc, accsize);
+  }
+
+  runjob(&job);
+
+  // combine the partial results left to right, so only associativity is required
+  for (size_t i = 0; i < job.nsegs; i++) {
+    combine(acc, job.segs[i].acc, ctx);
+  }
+
+  free(accs);
+  freesegments(job.segs, job.nsegs);
+  return 0;
+}
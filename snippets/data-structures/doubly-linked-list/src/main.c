@@ -1,15 +1,70 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "bench.h"
 #include "test.h"
+#include "trace.h"
 
 
 int main()
 {
-  test_intcmp();
-  test_create_destroy();
-  test_addfirst();
-  test_addlast();
-  test_popfirst();
+#ifdef NDEBUG
+  /* release builds run the benchmarks, since asserts are compiled out */
+  bench_extsort();
+  bench_skiplist();
+  bench_rculist();
+  bench_alloc();
+  bench_vec();
+  bench_deque();
+  bench_pqueue();
+  bench_bloom();
+  bench_threadpool();
+  bench_ilist();
+  bench_pvec();
+  bench_ebr();
+  bench_teardown();
+#else
+  /* each test also reports its counters, see test_run */
+  RUN_TEST(test_intcmp);
+  RUN_TEST(test_create_destroy);
+  RUN_TEST(test_addfirst);
+  RUN_TEST(test_addlast);
+  RUN_TEST(test_popfirst);
+  RUN_TEST(test_extsort_inmemory);
+  RUN_TEST(test_extsort_spill);
+  RUN_TEST(test_extsort_empty);
+  RUN_TEST(test_extsort_corrupt);
+  RUN_TEST(test_skiplist_insert_contains);
+  RUN_TEST(test_skiplist_remove);
+  RUN_TEST(test_skiplist_iter);
+  RUN_TEST(test_rculist_basic);
+  RUN_TEST(test_rculist_concurrent);
+  RUN_TEST(test_arena);
+  RUN_TEST(test_list_allocator);
+  RUN_TEST(test_string_allocator);
+  RUN_TEST(test_vec_basic);
+  RUN_TEST(test_pdqsort);
+  RUN_TEST(test_vec_sort_bsearch);
+  RUN_TEST(test_vec_typed);
+  RUN_TEST(test_deque_ends);
+  RUN_TEST(test_deque_queue);
+  RUN_TEST(test_pqueue_order);
+  RUN_TEST(test_pqueue_heapify);
+  RUN_TEST(test_pqueue_decreasekey);
+  RUN_TEST(test_bloom_basic);
+  RUN_TEST(test_list_filter);
+  RUN_TEST(test_threadpool_fib);
+  RUN_TEST(test_list_parallel);
+  RUN_TEST(test_ilist_basic);
+  RUN_TEST(test_ilist_sort_compact);
+  RUN_TEST(test_pvec_basic);
+  RUN_TEST(test_pvec_snapshot);
+  RUN_TEST(test_ebr_basic);
+  RUN_TEST(test_ebr_threads);
+  RUN_TEST(test_perf);
+  RUN_TEST(test_trace);
+  test_teardown();
+#endif
+  if (TRACE_EXPORT("trace.json") < 0) return EXIT_FAILURE;
   return EXIT_SUCCESS;
 } 
@@ -0,0 +1,352 @@
+#include "defs.h"
+#include "pdqsort.h"
+#include "printing.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Port of pdqsort by Orson Peters <https://github.com/orlp/pdqsort>, without the
+ * branchless block partitioning. Elements are handled as `size` byte blocks so the
+ * same code sorts both plain arrays and arrays of item pointers.
+ */
+
+/* partitions below this size are sorted with insertion sort */
+#define INSERTION_SORT_THRESHOLD 24
+
+/* partitions above this size use the pseudomedian of nine as pivot */
+#define NINTHER_THRESHOLD 128
+
+/* when we detect an already sorted partition, attempt an insertion sort that allows
+ * this amount of element moves before giving up */
+#define PARTIAL_INSERTION_SORT_LIMIT 8
+
+/* element scratch space on the stack, larger elements use the heap */
+#define STACK_TMP 64
+
+/* pointer-sized slot that may sit at any alignment and alias any element type */
+typedef void *slot_t __attribute__((aligned(1), may_alias));
+
+typedef struct sorter {
+  size_t size;
+  cmp_fn cmpfn;
+  bool indirect;  /* slots hold item pointers, and cmpfn compares the items */
+  char *tmp;      /* one element of scratch */
+  char *pivot;    /* one element holding the pivot during partitioning */
+} sorter_t;
+
+#define AT(p, i) ((p) + (ptrdiff_t) (i) * (ptrdiff_t) s->size)
+#define NEXT(p)  ((p) + s->size)
+#define PREV(p)  ((p) - s->size)
+#define DIST(a, b) ((size_t) (((b) - (a)) / (ptrdiff_t) s->size))
+
+
+static inline bool less(const sorter_t *s, const char *a, const char *b) {
+  if (s->indirect) return s->cmpfn(*(void *const *) a, *(void *const *) b) < 0;
+  return s->cmpfn(a, b) < 0;
+}
+
+static inline void copy(const sorter_t *s, char *dst, const char *src) {
+  // one load and store for pointer-sized elements, instead of a call to memcpy
+  if (sizeof(slot_t) == s->size) {
+    *(slot_t *) dst = *(const slot_t *) src;
+  } else {
+    memcpy(dst, src, s->size);
+  }
+}
+
+static inline void swap(const sorter_t *s, char *a, char *b) {
+  if (sizeof(slot_t) == s->size) {
+    void *t = *(slot_t *) a;
+    *(slot_t *) a = *(slot_t *) b;
+    *(slot_t *) b = t;
+    return;
+  }
+
+  for (size_t i = 0; i < s->size; i++) {
+    char t = a[i];
+    a[i] = b[i];
+    b[i] = t;
+  }
+}
+
+static void insertion_sort(const sorter_t *s, char *begin, char *end) {
+  if (begin == end) return;
+
+  for (char *cur = NEXT(begin); cur < end; cur = NEXT(cur)) {
+    char *sift = cur;
+    char *sift_1 = PREV(cur);
+
+    if (less(s, sift, sift_1)) {
+      copy(s, s->tmp, sift);
+      do {
+        copy(s, sift, sift_1);
+        sift = sift_1;
+      } while (sift != begin && less(s, s->tmp, sift_1 = PREV(sift)));
+      copy(s, sift, s->tmp);
+    }
+  }
+}
+
+/* Insertion sort that assumes the element before `begin` is <= every element in the range */
+static void unguarded_insertion_sort(const sorter_t *s, char *begin, char *end) {
+  if (begin == end) return;
+
+  for (char *cur = NEXT(begin); cur < end; cur = NEXT(cur)) {
+    char *sift = cur;
+    char *sift_1 = PREV(cur);
+
+    if (less(s, sift, sift_1)) {
+      copy(s, s->tmp, sift);
+      do {
+        copy(s, sift, sift_1);
+        sift = sift_1;
+      } while (less(s, s->tmp, sift_1 = PREV(sift)));
+      copy(s, sift, s->tmp);
+    }
+  }
+}
+
+/* Attempts an insertion sort, giving up after PARTIAL_INSERTION_SORT_LIMIT moves.
+ * Returns true if the range is now sorted. */
+static bool partial_insertion_sort(const sorter_t *s, char *begin, char *end) {
+  if (begin == end) return true;
+
+  size_t limit = 0;
+  for (char *cur = NEXT(begin); cur < end; cur = NEXT(cur)) {
+    char *sift = cur;
+    char *sift_1 = PREV(cur);
+
+    if (less(s, sift, sift_1)) {
+      copy(s, s->tmp, sift);
+      do {
+        copy(s, sift, sift_1);
+        sift = sift_1;
+      } while (sift != begin && less(s, s->tmp, sift_1 = PREV(sift)));
+      copy(s, sift, s->tmp);
+      limit += DIST(sift, cur);
+    }
+
+    if (limit > PARTIAL_INSERTION_SORT_LIMIT) return false;
+  }
+
+  return true;
+}
+
+static inline void sort2(const sorter_t *s, char *a, char *b) {
+  if (less(s, b, a)) swap(s, a, b);
+}
+
+static inline void sort3(const sorter_t *s, char *a, char *b, char *c) {
+  sort2(s, a, b);
+  sort2(s, b, c);
+  sort2(s, a, b);
+}
+
+static void siftdown(const sorter_t *s, char *base, size_t root, size_t n) {
+  for (;;) {
+    size_t child = 2 * root + 1;
+    if (child >= n) return;
+    if (child + 1 < n && less(s, AT(base, child), AT(base, child + 1))) child++;
+    if (!less(s, AT(base, root), AT(base, child))) return;
+    swap(s, AT(base, root), AT(base, child));
+    root = child;
+  }
+}
+
+static void heapsort_(const sorter_t *s, char *begin, char *end) {
+  size_t n = DIST(begin, end);
+  for (size_t i = n / 2; i-- > 0;) {
+    siftdown(s, begin, i, n);
+  }
+  for (size_t i = n; i-- > 1;) {
+    swap(s, begin, AT(begin, i));
+    siftdown(s, begin, 0, i);
+  }
+}
+
+/*
+ * Partitions [begin, end) around the pivot *begin. Elements equal to the pivot are put
+ * in the right-hand partition. Returns the position of the pivot after partitioning, and
+ * sets `*already_partitioned` if no elements had to be swapped.
+ */
+static char *partition_right(const sorter_t *s, char *begin, char *end, bool *already_partitioned) {
+  copy(s, s->pivot, begin);
+  char *first = begin;
+  char *last = end;
+
+  /* find the first element >= pivot. The median of 3 guarantees one exists */
+  while (less(s, first = NEXT(first), s->pivot));
+
+  /* find the first element strictly smaller than the pivot. If there was no element
+   * before first, guard the search */
+  if (PREV(first) == begin) {
+    while (first < last && !less(s, last = PREV(last), s->pivot));
+  } else {
+    while (!less(s, last = PREV(last), s->pivot));
+  }
+
+  *already_partitioned = first >= last;
+
+  while (first < last) {
+    swap(s, first, last);
+    while (less(s, first = NEXT(first), s->pivot));
+    while (!less(s, last = PREV(last), s->pivot));
+  }
+
+  char *pivot_pos = PREV(first);
+  copy(s, begin, pivot_pos);
+  copy(s, pivot_pos, s->pivot);
+
+  return pivot_pos;
+}
+
+/*
+ * Like partition_right, but elements equal to the pivot go to the left. Used when the
+ * pivot equals the element before the partition, in which case the left-hand side is
+ * all equal elements and needs no further sorting.
+ */
+static char *partition_left(const sorter_t *s, char *begin, char *end) {
+  copy(s, s->pivot, begin);
+  char *first = begin;
+  char *last = end;
+
+  while (less(s, s->pivot, last = PREV(last)));
+
+  if (NEXT(last) == end) {
+    while (first < last && !less(s, s->pivot, first = NEXT(first)));
+  } else {
+    while (!less(s, s->pivot, first = NEXT(first)));
+  }
+
+  while (first < last) {
+    swap(s, first, last);
+    while (less(s, s->pivot, last = PREV(last)));
+    while (!less(s, s->pivot, first = NEXT(first)));
+  }
+
+  char *pivot_pos = last;
+  copy(s, begin, pivot_pos);
+  copy(s, pivot_pos, s->pivot);
+
+  return pivot_pos;
+}
+
+static void pdqsort_loop(const sorter_t *s, char *begin, char *end, int bad_allowed, bool leftmost) {
+  for (;;) {
+    size_t size = DIST(begin, end);
+
+    if (size < INSERTION_SORT_THRESHOLD) {
+      if (leftmost) {
+        insertion_sort(s, begin, end);
+      } else {
+        unguarded_insertion_sort(s, begin, end);
+      }
+      return;
+    }
+
+    /* choose pivot as median of 3 or pseudomedian of 9, and move it to begin */
+    size_t s2 = size / 2;
+    if (size > NINTHER_THRESHOLD) {
+      sort3(s, begin, AT(begin, s2), PREV(end));
+      sort3(s, NEXT(begin), AT(begin, s2 - 1), AT(end, -2));
+      sort3(s, AT(begin, 2), AT(begin, s2 + 1), AT(end, -3));
+      sort3(s, AT(begin, s2 - 1), AT(begin, s2), AT(begin, s2 + 1));
+      swap(s, begin, AT(begin, s2));
+    } else {
+      sort3(s, AT(begin, s2), begin, PREV(end));
+    }
+
+    /* if the pivot equals the element before this partition, everything equal to it is
+     * already in place. Partition those to the left and continue with the rest */
+    if (!leftmost && !less(s, PREV(begin), begin)) {
+      begin = NEXT(partition_left(s, begin, end));
+      continue;
+    }
+
+    bool already_partitioned;
+    char *pivot_pos = partition_right(s, begin, end, &already_partitioned);
+
+    size_t l_size = DIST(begin, pivot_pos);
+    size_t r_size = DIST(NEXT(pivot_pos), end);
+    bool highly_unbalanced = l_size < size / 8 || r_size < size / 8;
+
+    if (highly_unbalanced) {
+      /* too many bad partitions, fall back to a guaranteed O(n log n) sort */
+      if (--bad_allowed == 0) {
+        heapsort_(s, begin, end);
+        return;
+      }
+
+      /* break up patterns that may be causing the bad partitions */
+      if (l_size >= INSERTION_SORT_THRESHOLD) {
+        swap(s, begin, AT(begin, l_size / 4));
+        swap(s, PREV(pivot_pos), AT(pivot_pos, -(ptrdiff_t) (l_size / 4)));
+
+        if (l_size > NINTHER_THRESHOLD) {
+          swap(s, AT(begin, 1), AT(begin, l_size / 4 + 1));
+          swap(s, AT(begin, 2), AT(begin, l_size / 4 + 2));
+          swap(s, AT(pivot_pos, -2), AT(pivot_pos, -(ptrdiff_t) (l_size / 4 + 1)));
+          swap(s, AT(pivot_pos, -3), AT(pivot_pos, -(ptrdiff_t) (l_size / 4 + 2)));
+        }
+      }
+
+      if (r_size >= INSERTION_SORT_THRESHOLD) {
+        swap(s, AT(pivot_pos, 1), AT(pivot_pos, 1 + r_size / 4));
+        swap(s, PREV(end), AT(end, -(ptrdiff_t) (r_size / 4)));
+
+        if (r_size > NINTHER_THRESHOLD) {
+          swap(s, AT(pivot_pos, 2), AT(pivot_pos, 2 + r_size / 4));
+          swap(s, AT(pivot_pos, 3), AT(pivot_pos, 3 + r_size / 4));
+          swap(s, AT(end, -2), AT(end, -(ptrdiff_t) (1 + r_size / 4)));
+          swap(s, AT(end, -3), AT(end, -(ptrdiff_t) (2 + r_size / 4)));
+        }
+      }
+    } else {
+      /* a decently balanced partition that needed no swaps is likely already sorted */
+      if (already_partitioned && partial_insertion_sort(s, begin, pivot_pos) &&
+          partial_insertion_sort(s, NEXT(pivot_pos), end)) {
+        return;
+      }
+    }
+
+    /* recurse into the left partition, loop on the right */
+    pdqsort_loop(s, begin, pivot_pos, bad_allowed, leftmost);
+    begin = NEXT(pivot_pos);
+    leftmost = false;
+  }
+}
+
+static void sort(char *base, size_t nmemb, size_t size, cmp_fn cmpfn, bool indirect) {
+  if (nmemb < 2) return;
+
+  _Alignas(max_align_t) char stacktmp[2 * STACK_TMP];
+  char *tmp = stacktmp;
+  if (size > STACK_TMP) {
+    tmp = malloc(2 * size);
+    if (NULL == tmp) PANIC("Failed to allocate scratch space for sorting\n");
+  }
+
+  sorter_t sorter = {size, cmpfn, indirect, tmp, tmp + size};
+  const sorter_t *s = &sorter;
+
+  int log2n = 0;
+  for (size_t n = nmemb; n > 1; n >>= 1) {
+    log2n++;
+  }
+
+  pdqsort_loop(s, base, AT(base, nmemb), log2n, true);
+
+  if (tmp != stacktmp) free(tmp);
+}
+
+void pdqsort(void *base, size_t nmemb, size_t size, cmp_fn cmpfn) {
+  sort(base, nmemb, size, cmpfn, false);
+}
+
+void pdqsort_items(void **items, size_t nmemb, cmp_fn cmpfn) {
+  sort((char *) items, nmemb, sizeof *items, cmpfn, true);
+}
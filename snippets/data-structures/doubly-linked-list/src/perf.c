@@ -0,0 +1,149 @@
+#include "perf.h"
+#include "printing.h"
+
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+
+struct perf {
+  int leader;               /* -1 if no counter could be opened */
+  int fds[PERF_NCOUNTERS];
+  int order[PERF_NCOUNTERS];  /* counters in the order they were added to the group */
+  int ncounters;
+  unsigned valid;
+  double start;
+};
+
+/* group read format, with PERF_FORMAT_GROUP | TOTAL_TIME_ENABLED | TOTAL_TIME_RUNNING */
+typedef struct groupread {
+  uint64_t nr;
+  uint64_t enabled;
+  uint64_t running;
+  uint64_t values[PERF_NCOUNTERS];
+} groupread_t;
+
+static const struct {
+  uint32_t type;
+  uint64_t config;
+  const char *unit;
+} events[PERF_NCOUNTERS] = {
+  [PERF_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cyc"},
+  [PERF_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "ins"},
+  [PERF_L1DMISSES] = {PERF_TYPE_HW_CACHE,
+                      PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+                        PERF_COUNT_HW_CACHE_RESULT_MISS << 16,
+                      "L1d"},
+  [PERF_LLCMISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "LLC"},
+  [PERF_BRANCHMISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "brmiss"},
+};
+
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+static int openevent(perf_counter_t counter, int group) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof attr);
+  attr.size = sizeof attr;
+  attr.type = events[counter].type;
+  attr.config = events[counter].config;
+  attr.disabled = -1 == group;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  return (int) syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+
+perf_t *perf_create(void) {
+  perf_t *perf = malloc(sizeof *perf);
+  if (NULL == perf) {
+    pr_error("Failed to allocate memory for perf counters\n");
+    return NULL;
+  }
+
+  perf->leader = -1;
+  perf->ncounters = 0;
+  perf->valid = 0;
+  perf->start = 0.0;
+
+  for (int c = 0; c < PERF_NCOUNTERS; c++) {
+    perf->fds[c] = openevent(c, perf->leader);
+    if (perf->fds[c] < 0) continue;
+
+    if (-1 == perf->leader) perf->leader = perf->fds[c];
+    perf->order[perf->ncounters++] = c;
+    perf->valid |= 1u << c;
+  }
+
+  if (0 == perf->valid) pr_warn("No hardware counters available, timing only\n");
+  return perf;
+}
+
+void perf_destroy(perf_t *perf) {
+  if (NULL == perf) return;
+
+  for (int c = 0; c < PERF_NCOUNTERS; c++) {
+    if (perf->fds[c] >= 0) close(perf->fds[c]);
+  }
+  free(perf);
+}
+
+unsigned perf_available(perf_t *perf) { return perf->valid; }
+
+void perf_start(perf_t *perf) {
+  if (perf->leader >= 0) {
+    ioctl(perf->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(perf->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+  perf->start = now();
+}
+
+void perf_stop(perf_t *perf, perf_sample_t *sample) {
+  double end = now();
+  groupread_t data;
+
+  if (perf->leader >= 0) ioctl(perf->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+  memset(sample, 0, sizeof *sample);
+  sample->seconds = end - perf->start;
+
+  if (perf->leader < 0 || read(perf->leader, &data, sizeof data) <= 0) return;
+  // never scheduled onto the PMU, e.g. because other groups took all counters
+  if (0 == data.running) return;
+
+  double scale = (double) data.enabled / (double) data.running;
+  for (uint64_t i = 0; i < data.nr && i < (uint64_t) perf->ncounters; i++) {
+    int c = perf->order[i];
+    sample->counts[c] = (uint64_t) ((double) data.values[i] * scale);
+  }
+  sample->valid = perf->valid;
+}
+
+int perf_format(const perf_sample_t *sample, size_t nelems, char *buf, size_t size) {
+  double div = 0 == nelems ? 1.0 : (double) nelems;
+  int len = 0;
+
+  if (size > 0) buf[0] = '\0';
+  for (int c = 0; c < PERF_NCOUNTERS; c++) {
+    if (!(sample->valid & 1u << c)) continue;
+
+    // past the end of buf, only count what would have been written
+    int fits = (size_t) len < size;
+    len += snprintf(fits ? buf + len : NULL, fits ? size - len : 0, "%s%.3g %s",
+                    0 == len ? "" : " ", (double) sample->counts[c] / div, events[c].unit);
+  }
+
+  return len;
+}
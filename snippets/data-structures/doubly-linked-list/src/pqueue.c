@@ -0,0 +1,302 @@
+#include "alloc.h"
+#include "defs.h"
+#include "pqueue.h"
+#include "printing.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PQUEUE_MINCAP 16
+#define CACHELINE 64
+#define NOSLOT SIZE_MAX
+
+
+typedef struct entry {
+  void *item;
+  size_t slot;          /* handle of the item, index into `pos`, or NOSLOT if untracked */
+} entry_t;
+
+_Static_assert(PQUEUE_ARITY * sizeof(entry_t) == CACHELINE, "children of a node must fill one cache line");
+
+/*
+ * The children of node i are at ARITY * i + 1 ... ARITY * i + ARITY. Placing the root
+ * ROOTOFFSET entries past a cache line boundary puts node 1, and so every group of
+ * siblings, at the start of a cache line.
+ */
+#define ROOTOFFSET (CACHELINE / sizeof(entry_t) - 1)
+
+
+struct pqueue {
+  entry_t *heap;
+  void *raw;            /* unaligned allocation holding `heap` */
+  size_t rawsize;
+  size_t length;
+  size_t capacity;
+  size_t *pos;          /* heap index of each live slot, or the next free slot */
+  size_t nslots;
+  size_t freeslot;
+  cmp_fn cmpfn;
+  allocator_t allocator;
+  memstat_t mem;
+};
+
+
+static int grow(pqueue_t *pq, size_t mincap) {
+  size_t capacity = pq->capacity ? pq->capacity * 2 : PQUEUE_MINCAP;
+  if (capacity < mincap) capacity = mincap;
+
+  size_t rawsize = (capacity + ROOTOFFSET) * sizeof(entry_t) + CACHELINE - 1;
+  void *raw = mem_alloc(&pq->allocator, &pq->mem, rawsize);
+  if (NULL == raw) {
+    pr_error("Failed to grow priority queue to %zu items\n", capacity);
+    return -1;
+  }
+
+  size_t *pos = mem_realloc(&pq->allocator, &pq->mem, pq->pos,
+                            pq->capacity * sizeof *pos, capacity * sizeof *pos);
+  if (NULL == pos) {
+    pr_error("Failed to grow priority queue to %zu items\n", capacity);
+    mem_free(&pq->allocator, &pq->mem, raw, rawsize);
+    return -1;
+  }
+
+  uintptr_t line = ((uintptr_t) raw + CACHELINE - 1) & ~(uintptr_t) (CACHELINE - 1);
+  entry_t *heap = (entry_t *) line + ROOTOFFSET;
+  if (pq->length > 0) memcpy(heap, pq->heap, pq->length * sizeof *heap);
+
+  mem_free(&pq->allocator, &pq->mem, pq->raw, pq->rawsize);
+  pq->heap = heap;
+  pq->raw = raw;
+  pq->rawsize = rawsize;
+  pq->pos = pos;
+  pq->capacity = capacity;
+
+  return 0;
+}
+
+static size_t newslot(pqueue_t *pq) {
+  if (NOSLOT == pq->freeslot) return pq->nslots++;
+
+  size_t slot = pq->freeslot;
+  pq->freeslot = pq->pos[slot];
+  return slot;
+}
+
+static inline void place(pqueue_t *pq, size_t i, entry_t e) {
+  pq->heap[i] = e;
+  if (NOSLOT != e.slot) pq->pos[e.slot] = i;
+}
+
+/* Index of the smallest of the (up to) ARITY children starting at `first`, which share one cache line */
+static inline size_t minchild(pqueue_t *pq, size_t first) {
+  size_t last = first + PQUEUE_ARITY < pq->length ? first + PQUEUE_ARITY : pq->length;
+
+  // start loading every sibling's item before the first comparison needs one
+  for (size_t c = first; c < last; c++) {
+    __builtin_prefetch(pq->heap[c].item);
+  }
+
+  size_t best = first;
+  for (size_t c = first + 1; c < last; c++) {
+    if (pq->cmpfn(pq->heap[c].item, pq->heap[best].item) < 0) best = c;
+  }
+
+  return best;
+}
+
+static void siftup(pqueue_t *pq, size_t i) {
+  entry_t e = pq->heap[i];
+
+  while (i > 0) {
+    size_t parent = (i - 1) / PQUEUE_ARITY;
+    if (pq->cmpfn(e.item, pq->heap[parent].item) >= 0) break;
+
+    place(pq, i, pq->heap[parent]);
+    i = parent;
+  }
+
+  place(pq, i, e);
+}
+
+static void siftdown(pqueue_t *pq, size_t i) {
+  entry_t e = pq->heap[i];
+
+  for (;;) {
+    size_t first = PQUEUE_ARITY * i + 1;
+    if (first >= pq->length) break;
+
+    size_t best = minchild(pq, first);
+
+    if (pq->cmpfn(pq->heap[best].item, e.item) >= 0) break;
+
+    place(pq, i, pq->heap[best]);
+    i = best;
+  }
+
+  place(pq, i, e);
+}
+
+/*
+ * Removes the root by moving the hole down to a leaf along the smallest children, then sifting
+ * the last entry up from there. The last entry usually belongs near the bottom, so this skips
+ * the comparison against it at every level that a plain sift-down would make.
+ */
+static void poproot(pqueue_t *pq) {
+  size_t i = 0;
+
+  for (;;) {
+    size_t first = PQUEUE_ARITY * i + 1;
+    if (first >= pq->length) break;
+
+    size_t best = minchild(pq, first);
+
+    place(pq, i, pq->heap[best]);
+    i = best;
+  }
+
+  pq->heap[i] = pq->heap[pq->length];
+  siftup(pq, i);
+}
+
+
+pqueue_t *pqueue_create(cmp_fn cmpfn) { return pqueue_create_with_allocator(cmpfn, NULL); }
+
+pqueue_t *pqueue_create_with_allocator(cmp_fn cmpfn, const allocator_t *allocator) {
+  if (NULL == cmpfn) {
+    pr_error("Failed compare function not given\n");
+    return NULL;
+  }
+  if (NULL == allocator) allocator = &stdlib_allocator;
+
+  pqueue_t *pq = allocator->alloc(allocator->ctx, sizeof *pq);
+  if (NULL == pq) {
+    pr_error("Failed to allocate memory for priority queue\n");
+    return NULL;
+  }
+
+  pq->heap = NULL;
+  pq->raw = NULL;
+  pq->rawsize = 0;
+  pq->length = 0;
+  pq->capacity = 0;
+  pq->pos = NULL;
+  pq->nslots = 0;
+  pq->freeslot = NOSLOT;
+  pq->cmpfn = cmpfn;
+  pq->allocator = *allocator;
+  pq->mem.inuse = sizeof *pq;
+  pq->mem.peak = sizeof *pq;
+
+  return pq;
+}
+
+void pqueue_destroy(pqueue_t *pq, free_fn item_free) {
+  if (NULL == pq) return;
+
+  if (NULL != item_free) {
+    for (size_t i = 0; i < pq->length; i++) {
+      item_free(pq->heap[i].item);
+    }
+  }
+
+  mem_free(&pq->allocator, &pq->mem, pq->raw, pq->rawsize);
+  mem_free(&pq->allocator, &pq->mem, pq->pos, pq->capacity * sizeof *pq->pos);
+  allocator_t allocator = pq->allocator;
+  allocator.free(allocator.ctx, pq, sizeof *pq);
+}
+
+size_t pqueue_length(pqueue_t *pq) { return pq->length; }
+
+void pqueue_memstat(pqueue_t *pq, memstat_t *stat) { *stat = pq->mem; }
+
+int pqueue_push(pqueue_t *pq, void *item, pqueue_handle_t *handle) {
+  if (NULL == pq || NULL == item) {
+    pr_error("Priority queue parameter and item parameter not given\n");
+    return -1;
+  }
+
+  if (pq->length == pq->capacity && grow(pq, 0) < 0) return -1;
+
+  // only items pushed with a handle are tracked in `pos`
+  size_t slot = NULL != handle ? newslot(pq) : NOSLOT;
+  pq->heap[pq->length].item = item;
+  pq->heap[pq->length].slot = slot;
+  pq->length += 1;
+  siftup(pq, pq->length - 1);
+
+  if (NULL != handle) *handle = slot;
+  return 0;
+}
+
+int pqueue_heapify(pqueue_t *pq, void **items, size_t n, pqueue_handle_t *handles) {
+  if (NULL == pq || (NULL == items && n > 0)) {
+    pr_error("Priority queue parameter and items parameter not given\n");
+    return -1;
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    if (NULL == items[i]) {
+      pr_error("Item %zu is NULL\n", i);
+      return -1;
+    }
+  }
+
+  if (pq->length + n > pq->capacity && grow(pq, pq->length + n) < 0) return -1;
+
+  for (size_t i = 0; i < n; i++) {
+    entry_t e = {items[i], NULL != handles ? newslot(pq) : NOSLOT};
+    place(pq, pq->length, e);
+    pq->length += 1;
+    if (NULL != handles) handles[i] = e.slot;
+  }
+
+  // Floyd's bottom-up construction, from the last node with children to the root
+  if (pq->length > 1) {
+    for (size_t i = (pq->length - 2) / PQUEUE_ARITY + 1; i-- > 0;) {
+      siftdown(pq, i);
+    }
+  }
+
+  return 0;
+}
+
+void *pqueue_pop(pqueue_t *pq) {
+  if (NULL == pq || 0 == pq->length) PANIC("Priority queue is empty, PANICING(exiting)\n");
+
+  void *returnData = pq->heap[0].item;
+  size_t slot = pq->heap[0].slot;
+
+  pq->length -= 1;
+  if (pq->length > 0) poproot(pq);
+
+  if (NOSLOT != slot) {
+    pq->pos[slot] = pq->freeslot;
+    pq->freeslot = slot;
+  }
+
+  return returnData;
+}
+
+void *pqueue_peek(pqueue_t *pq) {
+  if (NULL == pq || 0 == pq->length) return NULL;
+
+  return pq->heap[0].item;
+}
+
+int pqueue_decreasekey(pqueue_t *pq, pqueue_handle_t handle) {
+  if (NULL == pq || handle >= pq->nslots) {
+    pr_error("Invalid priority queue handle\n");
+    return -1;
+  }
+
+  // free slots hold a freelist link in `pos`, and no heap entry refers to them
+  size_t i = pq->pos[handle];
+  if (i >= pq->length || pq->heap[i].slot != handle) {
+    pr_error("Invalid priority queue handle\n");
+    return -1;
+  }
+
+  siftup(pq, i);
+  return 0;
+}
@@ -0,0 +1,365 @@
+#include "printing.h"
+#include "pvec.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MASK (PVEC_BRANCH - 1)
+
+
+/* Inner nodes hold child nodes in their slots, leaves (level 0) hold items */
+typedef struct pnode {
+  atomic_size_t refs;
+  void *slots[PVEC_BRANCH];
+} pnode_t;
+
+/*
+ * Items [0, tailoffset) are in the trie below `root`, whose level is `shift`. The rest, at
+ * least one unless the vector is empty, are in `tail`.
+ */
+struct pvec {
+  pnode_t *root;
+  pnode_t *tail;
+  size_t length;
+  unsigned shift;
+};
+
+struct pvec_iter {
+  pvec_t *vec;
+  size_t index;
+  void **leaf;
+};
+
+
+static size_t tailoffset(size_t length) {
+  return length < PVEC_BRANCH ? 0 : ((length - 1) >> PVEC_BITS) << PVEC_BITS;
+}
+
+static pnode_t *newnode(void) {
+  pnode_t *node = malloc(sizeof *node);
+  if (NULL == node) {
+    pr_error("Failed to allocate persistent vector node\n");
+    return NULL;
+  }
+
+  atomic_init(&node->refs, 1);
+  memset(node->slots, 0, sizeof node->slots);
+  return node;
+}
+
+static void retain(pnode_t *node) {
+  if (NULL != node) atomic_fetch_add_explicit(&node->refs, 1, memory_order_relaxed);
+}
+
+static void release(pnode_t *node, unsigned level) {
+  if (NULL == node || 1 != atomic_fetch_sub_explicit(&node->refs, 1, memory_order_acq_rel)) return;
+
+  if (level > 0) {
+    for (size_t i = 0; i < PVEC_BRANCH; i++) {
+      release(node->slots[i], level - PVEC_BITS);
+    }
+  }
+  free(node);
+}
+
+/*
+ * Returns `node` if only the calling version references it, otherwise a private copy that
+ * takes over the reference, and must be stored in place of `node`. The copy holds the same
+ * items, so a failure part way down a path leaves the vector unchanged.
+ */
+static pnode_t *editable(pnode_t *node, unsigned level) {
+  if (1 == atomic_load_explicit(&node->refs, memory_order_acquire)) return node;
+
+  pnode_t *copy = newnode();
+  if (NULL == copy) return NULL;
+
+  memcpy(copy->slots, node->slots, sizeof copy->slots);
+  if (level > 0) {
+    for (size_t i = 0; i < PVEC_BRANCH; i++) {
+      retain(copy->slots[i]);
+    }
+  }
+  release(node, level);
+  return copy;
+}
+
+/* A chain of inner nodes from `level` down to `leaf` */
+static pnode_t *newpath(unsigned level, pnode_t *leaf) {
+  if (0 == level) return leaf;
+
+  pnode_t *node = newnode();
+  if (NULL == node) return NULL;
+
+  node->slots[0] = newpath(level - PVEC_BITS, leaf);
+  if (NULL == node->slots[0]) {
+    free(node);
+    return NULL;
+  }
+  return node;
+}
+
+/* Hangs a full leaf into the trie below the editable `node`, at item `index` */
+static int pushtail(pnode_t *node, unsigned level, size_t index, pnode_t *leaf) {
+  void **slot = &node->slots[(index >> level) & MASK];
+
+  if (PVEC_BITS == level) {
+    *slot = leaf;
+    return 0;
+  }
+  if (NULL == *slot) {
+    *slot = newpath(level - PVEC_BITS, leaf);
+    return NULL == *slot ? -1 : 0;
+  }
+
+  pnode_t *child = editable(*slot, level - PVEC_BITS);
+  if (NULL == child) return -1;
+  *slot = child;
+  return pushtail(child, level - PVEC_BITS, index, leaf);
+}
+
+/* Unhooks the leaf holding item `index`, the last one, from below the editable `node` */
+static pnode_t *poptail(pnode_t *node, unsigned level, size_t index) {
+  void **slot = &node->slots[(index >> level) & MASK];
+
+  if (PVEC_BITS == level) {
+    pnode_t *leaf = *slot;
+    *slot = NULL;
+    return leaf;
+  }
+
+  pnode_t *child = editable(*slot, level - PVEC_BITS);
+  if (NULL == child) return NULL;
+  *slot = child;
+
+  pnode_t *leaf = poptail(child, level - PVEC_BITS, index);
+  if (NULL != leaf && NULL == child->slots[0]) {
+    release(child, level - PVEC_BITS);
+    *slot = NULL;
+  }
+  return leaf;
+}
+
+/* The items of the leaf holding item `index` */
+static void **leafof(pvec_t *vec, size_t index) {
+  if (index >= tailoffset(vec->length)) return vec->tail->slots;
+
+  pnode_t *node = vec->root;
+  for (unsigned level = vec->shift; level > 0; level -= PVEC_BITS) {
+    node = node->slots[(index >> level) & MASK];
+  }
+  return node->slots;
+}
+
+
+pvec_t *pvec_create(void) {
+  pvec_t *vec = malloc(sizeof *vec);
+  if (NULL == vec) {
+    pr_error("Failed to allocate memory for persistent vector\n");
+    return NULL;
+  }
+
+  vec->root = NULL;
+  vec->tail = NULL;
+  vec->length = 0;
+  vec->shift = 0;
+  return vec;
+}
+
+void pvec_destroy(pvec_t *vec) {
+  if (NULL == vec) return;
+
+  release(vec->root, vec->shift);
+  release(vec->tail, 0);
+  free(vec);
+}
+
+pvec_t *pvec_snapshot(pvec_t *vec) {
+  pvec_t *snap = malloc(sizeof *snap);
+  if (NULL == snap) {
+    pr_error("Failed to allocate persistent vector snapshot\n");
+    return NULL;
+  }
+
+  *snap = *vec;
+  retain(vec->root);
+  retain(vec->tail);
+  return snap;
+}
+
+size_t pvec_length(pvec_t *vec) { return vec->length; }
+
+void *pvec_get(pvec_t *vec, size_t index) {
+  if (NULL == vec || index >= vec->length) return NULL;
+
+  return leafof(vec, index)[index & MASK];
+}
+
+int pvec_set(pvec_t *vec, size_t index, void *item) {
+  if (NULL == vec || index >= vec->length) {
+    pr_error("Index %zu out of bounds\n", index);
+    return -1;
+  }
+
+  pnode_t *node;
+  if (index >= tailoffset(vec->length)) {
+    node = editable(vec->tail, 0);
+    if (NULL == node) return -1;
+    vec->tail = node;
+  } else {
+    node = editable(vec->root, vec->shift);
+    if (NULL == node) return -1;
+    vec->root = node;
+
+    for (unsigned level = vec->shift; level > 0; level -= PVEC_BITS) {
+      void **slot = &node->slots[(index >> level) & MASK];
+      node = editable(*slot, level - PVEC_BITS);
+      if (NULL == node) return -1;
+      *slot = node;
+    }
+  }
+
+  node->slots[index & MASK] = item;
+  return 0;
+}
+
+int pvec_addlast(pvec_t *vec, void *item) {
+  if (NULL == vec || NULL == item) {
+    pr_error("Vec parameter and item parameter not given\n");
+    return -1;
+  }
+
+  size_t offset = tailoffset(vec->length);
+  size_t intail = vec->length - offset;
+
+  if (0 == vec->length) {
+    vec->tail = newnode();
+    if (NULL == vec->tail) return -1;
+  } else if (intail < PVEC_BRANCH) {
+    pnode_t *tail = editable(vec->tail, 0);
+    if (NULL == tail) return -1;
+    vec->tail = tail;
+  } else {
+    // the tail is full, move it into the trie and start a new one
+    pnode_t *tail = newnode();
+    if (NULL == tail) return -1;
+
+    if (NULL == vec->root) {
+      vec->root = vec->tail;
+    } else if (offset == (size_t) 1 << (vec->shift + PVEC_BITS)) {
+      // the trie is full, grow a level
+      pnode_t *root = newnode();
+      pnode_t *path = NULL == root ? NULL : newpath(vec->shift, vec->tail);
+      if (NULL == path) {
+        free(root);
+        free(tail);
+        return -1;
+      }
+      root->slots[0] = vec->root;
+      root->slots[1] = path;
+      vec->root = root;
+      vec->shift += PVEC_BITS;
+    } else {
+      pnode_t *root = editable(vec->root, vec->shift);
+      if (NULL == root) {
+        free(tail);
+        return -1;
+      }
+      vec->root = root;
+      if (pushtail(root, vec->shift, offset, vec->tail) < 0) {
+        free(tail);
+        return -1;
+      }
+    }
+
+    vec->tail = tail;
+    intail = 0;
+  }
+
+  vec->tail->slots[intail] = item;
+  vec->length += 1;
+  return 0;
+}
+
+void *pvec_poplast(pvec_t *vec) {
+  if (NULL == vec || 0 == vec->length) PANIC("Vec is empty, PANICING(exiting)\n");
+
+  size_t offset = tailoffset(vec->length);
+  size_t intail = vec->length - offset;
+  void *returnData = vec->tail->slots[intail - 1];
+
+  // slots past the length are never read, so a shared tail need not be copied
+  if (intail > 1) {
+    vec->length -= 1;
+    return returnData;
+  }
+
+  pnode_t *tail = NULL;
+  if (1 == vec->length) {
+    // empty now
+  } else if (0 == vec->shift) {
+    tail = vec->root;
+    vec->root = NULL;
+  } else {
+    pnode_t *root = editable(vec->root, vec->shift);
+    if (NULL != root) {
+      vec->root = root;
+      tail = poptail(root, vec->shift, offset - 1);
+    }
+    if (NULL == tail) {
+      pr_error("Failed to copy persistent vector node\n");
+      return NULL;
+    }
+
+    // a root with a single child is replaced by that child
+    if (NULL == root->slots[1]) {
+      vec->root = root->slots[0];
+      root->slots[0] = NULL;
+      release(root, vec->shift);
+      vec->shift -= PVEC_BITS;
+    }
+  }
+
+  release(vec->tail, 0);
+  vec->tail = tail;
+  vec->length -= 1;
+  return returnData;
+}
+
+
+pvec_iter_t *pvec_createiter(pvec_t *vec) {
+  if (NULL == vec) {
+    pr_error("Vec parameter not given\n");
+    return NULL;
+  }
+
+  pvec_iter_t *iter = malloc(sizeof *iter);
+  if (NULL == iter) {
+    pr_error("Failed to allocate persistent vector iter\n");
+    return NULL;
+  }
+
+  iter->vec = vec;
+  iter->index = 0;
+  iter->leaf = NULL;
+  return iter;
+}
+
+void pvec_destroyiter(pvec_iter_t *iter) { free(iter); }
+
+int pvec_hasnext(pvec_iter_t *iter) { return iter->index < iter->vec->length; }
+
+void *pvec_next(pvec_iter_t *iter) {
+  if (NULL == iter || iter->index >= iter->vec->length) return NULL;
+
+  // descend once per leaf
+  if (0 == (iter->index & MASK)) iter->leaf = leafof(iter->vec, iter->index);
+  return iter->leaf[iter->index++ & MASK];
+}
+
+void pvec_resetiter(pvec_iter_t *iter) {
+  if (NULL == iter) return;
+
+  iter->index = 0;
+  iter->leaf = NULL;
+}
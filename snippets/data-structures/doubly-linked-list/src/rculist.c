@@ -0,0 +1,375 @@
+#include "defs.h"
+#include "rculist.h"
+#include "printing.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define CACHE_LINE 64
+
+
+typedef struct rcunode rcunode_t;
+struct rcunode {
+  rcunode_t *_Atomic next;
+  rcunode_t *prev;          /* only used by writers */
+  void *item;
+};
+
+typedef struct retired retired_t;
+struct retired {
+  retired_t *next;
+  rcunode_t *node;
+  free_fn item_free;
+};
+
+struct rculist_reader {
+  /* 0 while offline, otherwise the last grace period counter the reader observed.
+   * Each reader owns a cache line so announcements do not false-share. */
+  _Alignas(CACHE_LINE) _Atomic uint64_t ctr;
+  rculist_t *list;
+  rculist_reader_t *next;
+};
+
+struct rculist {
+  rcunode_t *_Atomic head;
+  rcunode_t *tail;
+  atomic_size_t length;
+  cmp_fn cmpfn;
+
+  pthread_mutex_t lock;     /* serializes writers and guards the reader registry */
+  _Atomic uint64_t gp;
+  rculist_reader_t *readers;
+  retired_t *retired;
+  size_t nretired;
+};
+
+struct rculist_iter {
+  rculist_reader_t *reader;
+  rcunode_t *node;
+};
+
+
+static rcunode_t *newnode(void *item) {
+  rcunode_t *node = malloc(sizeof *node);
+  if (NULL == node) {
+    pr_error("Failed to allocate new node for rcu list\n");
+    return NULL;
+  }
+
+  atomic_init(&node->next, NULL);
+  node->prev = NULL;
+  node->item = item;
+
+  return node;
+}
+
+rculist_t *rculist_create(cmp_fn cmpfn) {
+  if (NULL == cmpfn) {
+    pr_error("Failed compare function not given\n");
+    return NULL;
+  }
+
+  rculist_t *list = malloc(sizeof *list);
+  if (NULL == list) {
+    pr_error("Failed to allocate memory for rcu list\n");
+    return NULL;
+  }
+
+  atomic_init(&list->head, NULL);
+  list->tail = NULL;
+  atomic_init(&list->length, 0);
+  list->cmpfn = cmpfn;
+  pthread_mutex_init(&list->lock, NULL);
+  atomic_init(&list->gp, 1);
+  list->readers = NULL;
+  list->retired = NULL;
+  list->nretired = 0;
+
+  return list;
+}
+
+
+/* ---- grace periods ---- */
+
+
+/* Waits until every reader that was online when called has passed a quiescent state
+ * or gone offline. Called with the writer lock held. */
+static void wait_grace(rculist_t *list) {
+  uint64_t gp = atomic_fetch_add(&list->gp, 1) + 1;
+
+  for (rculist_reader_t *r = list->readers; NULL != r; r = r->next) {
+    uint64_t ctr;
+    while (0 != (ctr = atomic_load_explicit(&r->ctr, memory_order_acquire)) && ctr < gp) {
+      sched_yield();
+    }
+  }
+}
+
+static void freeretired(retired_t *r) {
+  while (NULL != r) {
+    retired_t *next = r->next;
+    if (NULL != r->item_free) r->item_free(r->node->item);
+    free(r->node);
+    free(r);
+    r = next;
+  }
+}
+
+/* Called with the writer lock held */
+static void reclaim(rculist_t *list) {
+  if (NULL == list->retired) return;
+
+  retired_t *batch = list->retired;
+  list->retired = NULL;
+  list->nretired = 0;
+
+  wait_grace(list);
+  freeretired(batch);
+}
+
+void rculist_synchronize(rculist_t *list) {
+  pthread_mutex_lock(&list->lock);
+  reclaim(list);
+  pthread_mutex_unlock(&list->lock);
+}
+
+rculist_reader_t *rculist_register(rculist_t *list) {
+  if (NULL == list) {
+    pr_error("List not given\n");
+    return NULL;
+  }
+
+  size_t size = (sizeof(rculist_reader_t) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+  rculist_reader_t *reader = aligned_alloc(CACHE_LINE, size);
+  if (NULL == reader) {
+    pr_error("Failed to allocate rcu list reader\n");
+    return NULL;
+  }
+
+  reader->list = list;
+
+  pthread_mutex_lock(&list->lock);
+  atomic_store(&reader->ctr, atomic_load(&list->gp));
+  reader->next = list->readers;
+  list->readers = reader;
+  pthread_mutex_unlock(&list->lock);
+
+  return reader;
+}
+
+void rculist_unregister(rculist_reader_t *reader) {
+  if (NULL == reader) return;
+
+  rculist_t *list = reader->list;
+  pthread_mutex_lock(&list->lock);
+
+  rculist_reader_t **pp = &list->readers;
+  while (*pp != reader) {
+    pp = &(*pp)->next;
+  }
+  *pp = reader->next;
+
+  pthread_mutex_unlock(&list->lock);
+  free(reader);
+}
+
+void rculist_quiescent(rculist_reader_t *reader) {
+  uint64_t gp = atomic_load_explicit(&reader->list->gp, memory_order_acquire);
+  atomic_store_explicit(&reader->ctr, gp, memory_order_release);
+  /* full barrier, as in liburcu, so that later reads of the list cannot move before the
+   * announcement, and the reader cannot miss an unlink the writer is waiting out */
+  atomic_thread_fence(memory_order_seq_cst);
+}
+
+void rculist_offline(rculist_reader_t *reader) {
+  atomic_store_explicit(&reader->ctr, 0, memory_order_release);
+}
+
+void rculist_online(rculist_reader_t *reader) { rculist_quiescent(reader); }
+
+
+/* ---- writers ---- */
+
+
+void rculist_destroy(rculist_t *list, free_fn item_free) {
+  if (NULL == list) return;
+
+  if (NULL != list->readers) {
+    pr_warn("Destroying rcu list with registered readers\n");
+  }
+
+  freeretired(list->retired);
+
+  rcunode_t *node = atomic_load_explicit(&list->head, memory_order_relaxed);
+  while (NULL != node) {
+    rcunode_t *next = atomic_load_explicit(&node->next, memory_order_relaxed);
+    if (NULL != item_free) item_free(node->item);
+    free(node);
+    node = next;
+  }
+
+  pthread_mutex_destroy(&list->lock);
+  free(list);
+}
+
+size_t rculist_length(rculist_t *list) {
+  return atomic_load_explicit(&list->length, memory_order_relaxed);
+}
+
+int rculist_addfirst(rculist_t *list, void *item) {
+  if (NULL == list || NULL == item) {
+    pr_error("List parameter and item parameter not given\n");
+    return -1;
+  }
+
+  rcunode_t *node = newnode(item);
+  if (NULL == node) return -1;
+
+  pthread_mutex_lock(&list->lock);
+
+  rcunode_t *head = atomic_load_explicit(&list->head, memory_order_relaxed);
+  atomic_store_explicit(&node->next, head, memory_order_relaxed);
+
+  /* publish: readers that see the node also see its item and next pointer */
+  atomic_store_explicit(&list->head, node, memory_order_release);
+
+  if (NULL != head) {
+    head->prev = node;
+  } else {
+    list->tail = node;
+  }
+  atomic_fetch_add_explicit(&list->length, 1, memory_order_relaxed);
+
+  pthread_mutex_unlock(&list->lock);
+  return 0;
+}
+
+int rculist_addlast(rculist_t *list, void *item) {
+  if (NULL == list || NULL == item) {
+    pr_error("List parameter and item parameter not given\n");
+    return -1;
+  }
+
+  rcunode_t *node = newnode(item);
+  if (NULL == node) return -1;
+
+  pthread_mutex_lock(&list->lock);
+
+  node->prev = list->tail;
+  if (NULL != list->tail) {
+    atomic_store_explicit(&list->tail->next, node, memory_order_release);
+  } else {
+    atomic_store_explicit(&list->head, node, memory_order_release);
+  }
+  list->tail = node;
+  atomic_fetch_add_explicit(&list->length, 1, memory_order_relaxed);
+
+  pthread_mutex_unlock(&list->lock);
+  return 0;
+}
+
+int rculist_remove(rculist_t *list, void *item, free_fn item_free) {
+  if (NULL == list || NULL == item) return 0;
+
+  retired_t *r = malloc(sizeof *r);
+
+  pthread_mutex_lock(&list->lock);
+
+  rcunode_t *node = atomic_load_explicit(&list->head, memory_order_relaxed);
+  while (NULL != node && list->cmpfn(node->item, item) != 0) {
+    node = atomic_load_explicit(&node->next, memory_order_relaxed);
+  }
+
+  if (NULL == node) {
+    pthread_mutex_unlock(&list->lock);
+    free(r);
+    return 0;
+  }
+
+  /* Unlink. The node keeps its next pointer, so readers currently on it can move on */
+  rcunode_t *succ = atomic_load_explicit(&node->next, memory_order_relaxed);
+  if (NULL != node->prev) {
+    atomic_store_explicit(&node->prev->next, succ, memory_order_release);
+  } else {
+    atomic_store_explicit(&list->head, succ, memory_order_release);
+  }
+  if (NULL != succ) {
+    succ->prev = node->prev;
+  } else {
+    list->tail = node->prev;
+  }
+  atomic_fetch_sub_explicit(&list->length, 1, memory_order_relaxed);
+
+  if (NULL == r) {
+    /* no memory to defer the free, so wait for readers right away */
+    pr_warn("Failed to allocate retire record, synchronizing\n");
+    wait_grace(list);
+    if (NULL != item_free) item_free(node->item);
+    free(node);
+  } else {
+    r->node = node;
+    r->item_free = item_free;
+    r->next = list->retired;
+    list->retired = r;
+    if (++list->nretired >= RCULIST_RETIRE_BATCH) reclaim(list);
+  }
+
+  pthread_mutex_unlock(&list->lock);
+  return 1;
+}
+
+
+/* ---- readers ---- */
+
+
+int rculist_contains(rculist_reader_t *reader, void *item) {
+  rculist_t *list = reader->list;
+  rcunode_t *node = atomic_load_explicit(&list->head, memory_order_acquire);
+
+  while (NULL != node) {
+    if (list->cmpfn(node->item, item) == 0) return 1;
+    node = atomic_load_explicit(&node->next, memory_order_acquire);
+  }
+
+  return 0;
+}
+
+rculist_iter_t *rculist_createiter(rculist_reader_t *reader) {
+  if (NULL == reader) {
+    pr_error("Reader not given\n");
+    return NULL;
+  }
+
+  rculist_iter_t *iter = malloc(sizeof *iter);
+  if (NULL == iter) {
+    pr_error("Failed to allocate rcu list iter\n");
+    return NULL;
+  }
+
+  iter->reader = reader;
+  iter->node = atomic_load_explicit(&reader->list->head, memory_order_acquire);
+
+  return iter;
+}
+
+void rculist_destroyiter(rculist_iter_t *iter) { free(iter); }
+
+int rculist_hasnext(rculist_iter_t *iter) { return NULL != iter->node; }
+
+void *rculist_next(rculist_iter_t *iter) {
+  if (NULL == iter || NULL == iter->node) return NULL;
+
+  void *returnData = iter->node->item;
+  iter->node = atomic_load_explicit(&iter->node->next, memory_order_acquire);
+
+  return returnData;
+}
+
+void rculist_resetiter(rculist_iter_t *iter) {
+  if (NULL == iter) return;
+
+  iter->node = atomic_load_explicit(&iter->reader->list->head, memory_order_acquire);
+}
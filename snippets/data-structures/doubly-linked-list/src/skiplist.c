@@ -0,0 +1,301 @@
+#include "defs.h"
+#include "skiplist.h"
+#include "printing.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/*
+ * Level probability is 1/4 rather than the textbook 1/2. The expected tower holds
+ * 1.33 pointers instead of 2, so the typical node (item, prev, height and one forward
+ * pointer) is 32 bytes and two fit in a cache line. There are half as many levels to
+ * descend, at the cost of about one extra comparison per level.
+ */
+#define LEVEL_BITS 2
+#define LEVEL_MASK ((1u << LEVEL_BITS) - 1)
+
+
+typedef struct slnode slnode_t;
+struct slnode {
+  void *item;
+  slnode_t *prev;    /* level 0 backlink, NULL for the first node */
+  unsigned int height;
+  slnode_t *next[];  /* tower of forward pointers, allocated with the node */
+};
+
+struct skiplist {
+  slnode_t *head;    /* sentinel with a full height tower */
+  slnode_t *tail;
+  size_t length;
+  unsigned int level;
+  cmp_fn cmpfn;
+  uint64_t rng;
+};
+
+struct skiplist_iter {
+  skiplist_t *sl;
+  slnode_t *node;    /* node after the cursor, NULL at the end */
+};
+
+
+static slnode_t *newnode(void *item, unsigned int height) {
+  slnode_t *node = malloc(sizeof *node + height * sizeof node->next[0]);
+  if (NULL == node) {
+    pr_error("Failed to allocate new node for skip list\n");
+    return NULL;
+  }
+
+  node->item = item;
+  node->prev = NULL;
+  node->height = height;
+  for (unsigned int i = 0; i < height; i++) {
+    node->next[i] = NULL;
+  }
+
+  return node;
+}
+
+static unsigned int randomlevel(skiplist_t *sl) {
+  /* xorshift64 */
+  uint64_t x = sl->rng;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  sl->rng = x;
+
+  unsigned int height = 1;
+  while (0 == (x & LEVEL_MASK) && height < SKIPLIST_MAXLEVEL) {
+    height++;
+    x >>= LEVEL_BITS;
+  }
+
+  return height;
+}
+
+/*
+ * Descends from the top level, and records in `update` (if given) the last node on each
+ * level whose item is < `item`, or <= `item` if `inclusive` is set. Returns the level 0
+ * predecessor, which is the head sentinel if there is none.
+ */
+static slnode_t *findpath(skiplist_t *sl, const void *item, int inclusive, slnode_t **update) {
+  slnode_t *x = sl->head;
+  slnode_t *stop = NULL;
+
+  for (unsigned int lvl = sl->level; lvl-- > 0;) {
+    slnode_t *next;
+    /* the node that ended the walk on the level above is known to be too large,
+     * so reaching it again ends this level without touching its item */
+    while (NULL != (next = x->next[lvl]) && next != stop) {
+      int c = sl->cmpfn(next->item, item);
+      if (c > 0 || (c == 0 && !inclusive)) break;
+      x = next;
+    }
+    stop = next;
+    if (NULL != update) update[lvl] = x;
+  }
+
+  return x;
+}
+
+
+skiplist_t *skiplist_create(cmp_fn cmpfn) {
+  if (NULL == cmpfn) {
+    pr_error("Failed compare function not given\n");
+    return NULL;
+  }
+
+  skiplist_t *sl = malloc(sizeof *sl);
+  if (NULL == sl) {
+    pr_error("Failed to allocate memory for skip list\n");
+    return NULL;
+  }
+
+  sl->head = newnode(NULL, SKIPLIST_MAXLEVEL);
+  if (NULL == sl->head) {
+    free(sl);
+    return NULL;
+  }
+
+  sl->tail = NULL;
+  sl->length = 0;
+  sl->level = 1;
+  sl->cmpfn = cmpfn;
+  sl->rng = 0x2545F4914F6CDD1DULL;
+
+  return sl;
+}
+
+void skiplist_destroy(skiplist_t *sl, free_fn item_free) {
+  if (NULL == sl) return;
+
+  slnode_t *node = sl->head->next[0];
+  while (NULL != node) {
+    slnode_t *next = node->next[0];
+    if (NULL != item_free) item_free(node->item);
+    free(node);
+    node = next;
+  }
+
+  free(sl->head);
+  free(sl);
+}
+
+size_t skiplist_length(skiplist_t *sl) { return sl->length; }
+
+int skiplist_insert(skiplist_t *sl, void *item) {
+  if (NULL == sl || NULL == item) {
+    pr_error("Skip list parameter and item parameter not given\n");
+    return -1;
+  }
+
+  slnode_t *update[SKIPLIST_MAXLEVEL];
+  slnode_t *pred = findpath(sl, item, 0, update);
+
+  slnode_t *succ = pred->next[0];
+  if (NULL != succ && sl->cmpfn(succ->item, item) == 0) return 1;
+
+  unsigned int height = randomlevel(sl);
+  slnode_t *node = newnode(item, height);
+  if (NULL == node) return -1;
+
+  for (unsigned int lvl = sl->level; lvl < height; lvl++) {
+    update[lvl] = sl->head;
+  }
+  if (height > sl->level) sl->level = height;
+
+  for (unsigned int lvl = 0; lvl < height; lvl++) {
+    node->next[lvl] = update[lvl]->next[lvl];
+    update[lvl]->next[lvl] = node;
+  }
+
+  node->prev = (pred == sl->head) ? NULL : pred;
+  if (NULL != succ) {
+    succ->prev = node;
+  } else {
+    sl->tail = node;
+  }
+
+  sl->length += 1;
+  return 0;
+}
+
+void *skiplist_get(skiplist_t *sl, void *item) {
+  if (NULL == sl || NULL == item) return NULL;
+
+  slnode_t *node = findpath(sl, item, 0, NULL)->next[0];
+  if (NULL != node && sl->cmpfn(node->item, item) == 0) return node->item;
+
+  return NULL;
+}
+
+int skiplist_contains(skiplist_t *sl, void *item) { return NULL != skiplist_get(sl, item); }
+
+void *skiplist_remove(skiplist_t *sl, void *item) {
+  if (NULL == sl || NULL == item) return NULL;
+
+  slnode_t *update[SKIPLIST_MAXLEVEL];
+  slnode_t *node = findpath(sl, item, 0, update)->next[0];
+  if (NULL == node || sl->cmpfn(node->item, item) != 0) return NULL;
+
+  for (unsigned int lvl = 0; lvl < node->height; lvl++) {
+    update[lvl]->next[lvl] = node->next[lvl];
+  }
+
+  if (NULL != node->next[0]) {
+    node->next[0]->prev = node->prev;
+  } else {
+    sl->tail = node->prev;
+  }
+
+  while (sl->level > 1 && NULL == sl->head->next[sl->level - 1]) {
+    sl->level -= 1;
+  }
+
+  void *returnData = node->item;
+  free(node);
+  sl->length -= 1;
+
+  return returnData;
+}
+
+void *skiplist_first(skiplist_t *sl) {
+  slnode_t *node = sl->head->next[0];
+  return node ? node->item : NULL;
+}
+
+void *skiplist_last(skiplist_t *sl) { return sl->tail ? sl->tail->item : NULL; }
+
+
+static skiplist_iter_t *newiter(skiplist_t *sl, slnode_t *node) {
+  skiplist_iter_t *iter = malloc(sizeof *iter);
+  if (NULL == iter) {
+    pr_error("Failed to allocate skip list iter\n");
+    return NULL;
+  }
+
+  iter->sl = sl;
+  iter->node = node;
+
+  return iter;
+}
+
+skiplist_iter_t *skiplist_createiter(skiplist_t *sl) {
+  if (NULL == sl) {
+    pr_error("Skip list not given\n");
+    return NULL;
+  }
+
+  return newiter(sl, sl->head->next[0]);
+}
+
+skiplist_iter_t *skiplist_lowerbound(skiplist_t *sl, void *item) {
+  if (NULL == sl || NULL == item) {
+    pr_error("Skip list parameter and item parameter not given\n");
+    return NULL;
+  }
+
+  return newiter(sl, findpath(sl, item, 0, NULL)->next[0]);
+}
+
+skiplist_iter_t *skiplist_upperbound(skiplist_t *sl, void *item) {
+  if (NULL == sl || NULL == item) {
+    pr_error("Skip list parameter and item parameter not given\n");
+    return NULL;
+  }
+
+  return newiter(sl, findpath(sl, item, 1, NULL)->next[0]);
+}
+
+void skiplist_destroyiter(skiplist_iter_t *iter) { free(iter); }
+
+int skiplist_hasnext(skiplist_iter_t *iter) { return NULL != iter->node; }
+
+void *skiplist_next(skiplist_iter_t *iter) {
+  if (NULL == iter || NULL == iter->node) return NULL;
+
+  void *returnData = iter->node->item;
+  iter->node = iter->node->next[0];
+
+  return returnData;
+}
+
+int skiplist_hasprev(skiplist_iter_t *iter) {
+  slnode_t *prev = iter->node ? iter->node->prev : iter->sl->tail;
+  return NULL != prev;
+}
+
+void *skiplist_prev(skiplist_iter_t *iter) {
+  if (NULL == iter) return NULL;
+
+  slnode_t *prev = iter->node ? iter->node->prev : iter->sl->tail;
+  if (NULL == prev) return NULL;
+
+  iter->node = prev;
+  return prev->item;
+}
+
+void skiplist_resetiter(skiplist_iter_t *iter) {
+  if (NULL == iter) return;
+
+  iter->node = iter->sl->head->next[0];
+}
@@ -0,0 +1,132 @@
+#include "test.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "list.h"
+#include "printing.h"
+#include "defs.h"
+#include "strings.h"
+
+static int intcmp(const int *a, const int *b)
+{
+  return *a - *b;
+}
+
+void test_arena()
+{
+  arena_t *arena = arena_create(256);
+  assert(arena != NULL);
+  allocator_t a = arena_allocator(arena);
+  memstat_t stat;
+
+  char *p = a.alloc(a.ctx, 10);
+  assert(p != NULL && (uintptr_t)p % 16 == 0);
+  memcpy(p, "arena", 6);
+
+  /* the most recent allocation grows in place */
+  char *q = a.realloc(a.ctx, p, 10, 100);
+  assert(q == p);
+  assert(strcmp(q, "arena") == 0);
+
+  /* larger than a block: moved to a block of its own, contents kept */
+  char *r = a.realloc(a.ctx, q, 100, 1000);
+  assert(r != NULL && r != q);
+  assert(strcmp(r, "arena") == 0);
+
+  /* freeing the most recent allocation rolls it back */
+  char *s = a.alloc(a.ctx, 32);
+  a.free(a.ctx, s, 32);
+  assert(a.alloc(a.ctx, 32) == s);
+
+  arena_memstat(arena, &stat);
+  assert(stat.inuse > 0 && stat.peak >= stat.inuse);
+
+  arena_reset(arena);
+  arena_memstat(arena, &stat);
+  assert(stat.inuse == 0);
+  assert(stat.peak >= 1000);
+
+  arena_destroy(arena);
+  pr_info("test_arena: PASSED\n");
+}
+
+void test_list_allocator()
+{
+  arena_t *arena = arena_create(0);
+  allocator_t a = arena_allocator(arena);
+  list_t *list = list_create_with_allocator((cmp_fn)intcmp, &a);
+  assert(list != NULL);
+
+  memstat_t empty, stat;
+  list_memstat(list, &empty);
+  assert(empty.inuse > 0 && empty.peak == empty.inuse);
+
+  int values[100];
+  for (int i = 0; i < 100; i++) {
+    values[i] = i;
+    assert(list_addlast(list, &values[i]) == 0);
+  }
+  list_memstat(list, &stat);
+  size_t nodesize = (stat.inuse - empty.inuse) / 100;
+  assert(nodesize > 0);
+  assert(stat.inuse == empty.inuse + 100 * nodesize);
+
+  /* iterators are not allocated from the list's allocator */
+  list_iter_t *iter = list_createiter(list);
+  list_memstat(list, &stat);
+  assert(stat.inuse == empty.inuse + 100 * nodesize);
+
+  for (int i = 0; i < 50; i++) {
+    list_popfirst(list);
+  }
+  list_memstat(list, &stat);
+  assert(stat.inuse == empty.inuse + 50 * nodesize);
+  assert(stat.peak == empty.inuse + 100 * nodesize);
+
+  list_destroy(list, NULL);
+  arena_destroy(arena);
+  list_destroyiter(iter);
+
+  /* default allocator */
+  list = list_create_with_allocator((cmp_fn)intcmp, NULL);
+  list_addfirst(list, &values[0]);
+  list_memstat(list, &stat);
+  assert(stat.inuse == empty.inuse + nodesize);
+  list_destroy(list, NULL);
+  pr_info("test_list_allocator: PASSED\n");
+}
+
+void test_string_allocator()
+{
+  arena_t *arena = arena_create(0);
+  allocator_t a = arena_allocator(arena);
+  memstat_t stat, arenastat;
+
+  String_t *s = string_create_with_allocator("arena", 32, &a);
+  assert(s != NULL);
+  assert(string_length(s) == 5);
+  assert(strcmp(string_cstr(s), "arena") == 0);
+
+  /* the header, the capacity and the null terminator, all from the arena */
+  string_memstat(s, &stat);
+  assert(stat.inuse > 32 && stat.peak == stat.inuse);
+  arena_memstat(arena, &arenastat);
+  assert(arenastat.inuse >= stat.inuse);
+
+  /* the capacity is raised to fit the initial contents */
+  String_t *t = string_create("a longer string", 4);
+  assert(t != NULL);
+  assert(string_length(t) == 15);
+  assert(strcmp(string_cstr(t), "a longer string") == 0);
+  string_memstat(t, &stat);
+  assert(stat.inuse > 15);
+
+  string_free(t);
+  string_free(NULL);
+  string_free(s);
+  arena_destroy(arena);
+  pr_info("test_string_allocator: PASSED\n");
+}
@@ -0,0 +1,203 @@
+#include "test.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bloom.h"
+#include "alloc.h"
+#include "list.h"
+#include "printing.h"
+#include "defs.h"
+
+static int intcmp(const int *a, const int *b)
+{
+  return (*a > *b) - (*a < *b);
+}
+
+static uint64_t inthash(const int *a)
+{
+  return (uint64_t)*a;
+}
+
+/* adds 0, 2, 4, ... and probes the odd numbers, which were never added */
+static double measure_fprate(double fprate)
+{
+  bloom_t *bf = bloom_create((hash64_fn)inthash, 10000, fprate);
+  assert(bf != NULL);
+
+  for (int i = 0; i < 20000; i += 2) {
+    bloom_add(bf, &i);
+  }
+  for (int i = 0; i < 20000; i += 2) {
+    assert(bloom_maycontain(bf, &i));
+  }
+
+  size_t positives = 0;
+  for (int i = 1; i < 200000; i += 2) {
+    positives += bloom_maycontain(bf, &i);
+  }
+
+  bloom_stats_t stats;
+  bloom_stats(bf, &stats);
+  assert(stats.capacity == 10000);
+  assert(stats.count == 10000);
+  assert(stats.fill > 0 && stats.fill < 1);
+
+  bloom_destroy(bf);
+  return positives / (200000 / 2.0);
+}
+
+void test_bloom_basic()
+{
+  assert(bloom_create(NULL, 100, 0.01) == NULL);
+  assert(bloom_create((hash64_fn)inthash, 100, 0) == NULL);
+  assert(bloom_create((hash64_fn)inthash, 100, 1) == NULL);
+
+  /* the measured rate stays close to the target */
+  assert(measure_fprate(0.01) < 0.02);
+  assert(measure_fprate(0.1) < 0.2);
+  assert(measure_fprate(0.001) < 0.003);
+
+  bloom_t *bf = bloom_create((hash64_fn)inthash, 100, 0.01);
+  int key = 42;
+  assert(!bloom_maycontain(bf, &key));
+  bloom_add(bf, &key);
+  assert(bloom_maycontain(bf, &key));
+
+  bloom_clear(bf);
+  assert(!bloom_maycontain(bf, &key));
+
+  bloom_stats_t stats;
+  bloom_stats(bf, &stats);
+  assert(stats.count == 0);
+  assert(stats.fill == 0);
+
+  bloom_destroy(bf);
+  pr_info("test_bloom_basic: PASSED\n");
+}
+
+/* fails allocations larger than a list node once `*ctx` is set, e.g. those of a filter */
+static void *smallonly_alloc(void *ctx, size_t size)
+{
+  if (*(int *)ctx && size > 64) return NULL;
+  return malloc(size);
+}
+
+static void *smallonly_realloc(void *ctx, void *ptr, size_t oldsize, size_t newsize)
+{
+  (void)oldsize;
+  if (*(int *)ctx && newsize > 64) return NULL;
+  return realloc(ptr, newsize);
+}
+
+static void smallonly_free(void *ctx, void *ptr, size_t size)
+{
+  (void)ctx;
+  (void)size;
+  free(ptr);
+}
+
+static int inlist(int *item, list_t *list)
+{
+  return list_contains(list, item);
+}
+
+void test_list_filter()
+{
+  list_t *list = list_create((cmp_fn)intcmp);
+  bloom_stats_t stats;
+  memstat_t before, after;
+  int values[1000];
+
+  assert(list_filterstats(list, &stats) < 0);
+  for (int i = 0; i < 10; i++) {
+    values[i] = i;
+    list_addlast(list, &values[i]);
+  }
+
+  list_memstat(list, &before);
+  assert(list_setfilter(list, (hash64_fn)inthash, 0.01) == 0);
+  list_memstat(list, &after);
+  assert(after.inuse > before.inuse);
+  assert(after.peak == after.inuse);
+
+  /* the filter is charged to the list, and a rebuild holds both filters at once */
+  assert(list_setfilter(list, (hash64_fn)inthash, 0.01) == 0);
+  list_memstat(list, &after);
+  assert(after.inuse > before.inuse);
+  assert(after.peak > after.inuse);
+  assert(list_setfilter(list, NULL, 0) == 0);
+  list_memstat(list, &after);
+  assert(after.inuse == before.inuse);
+  assert(list_setfilter(list, (hash64_fn)inthash, 0.01) == 0);
+
+  /* items added before and after the filter was attached, across rebuilds */
+  for (int i = 10; i < 1000; i++) {
+    values[i] = i;
+    if (i % 2) {
+      list_addlast(list, &values[i]);
+    } else {
+      list_addfirst(list, &values[i]);
+    }
+  }
+  for (int i = 0; i < 1000; i++) {
+    assert(list_contains(list, &i));
+  }
+  for (int i = 1000; i < 2000; i++) {
+    assert(!list_contains(list, &i));
+  }
+
+  assert(list_filterstats(list, &stats) == 0);
+  assert(stats.capacity >= 1000);
+  assert(stats.count == 1000);
+  assert(stats.estfprate < 0.05);
+
+  /* lookups from the threads of a pool, which share the filter */
+  threadpool_t *pool = threadpool_create(4);
+  list_t *probes = list_create((cmp_fn)intcmp);
+  int keys[2000];
+  for (int i = 0; i < 2000; i++) {
+    keys[i] = i;
+    list_addlast(probes, &keys[i]);
+  }
+  list_t *found = list_filter(pool, probes, (list_pred_fn)inlist, list);
+  assert(list_length(found) == 1000);
+  list_destroy(found, NULL);
+  list_destroy(probes, NULL);
+  threadpool_destroy(pool);
+
+  /* removed items may pass the filter, but are not found */
+  int key = 500;
+  assert(list_remove(list, &key) == &values[500]);
+  assert(!list_contains(list, &key));
+  key = 5000;
+  assert(list_remove(list, &key) == NULL);
+
+  assert(list_setfilter(list, (hash64_fn)inthash, 2.0) < 0);
+  assert(list_filterstats(list, &stats) == 0);
+
+  assert(list_setfilter(list, NULL, 0) == 0);
+  assert(list_filterstats(list, &stats) < 0);
+  key = 42;
+  assert(list_contains(list, &key));
+
+  list_setfilter(list, (hash64_fn)inthash, 0.05);
+  list_destroy(list, NULL);
+
+  /* items added while the filter cannot be rebuilt must still be found */
+  int failbig = 0;
+  allocator_t smallonly = { smallonly_alloc, smallonly_realloc, smallonly_free, &failbig };
+  list = list_create_with_allocator((cmp_fn)intcmp, &smallonly);
+  assert(list_setfilter(list, (hash64_fn)inthash, 0.01) == 0);
+  failbig = 1;
+  for (int i = 0; i < 70; i++) {
+    assert(list_addlast(list, &values[i]) == 0);
+  }
+  for (int i = 0; i < 70; i++) {
+    assert(list_contains(list, &i));
+  }
+  failbig = 0;
+  list_destroy(list, NULL);
+
+  pr_info("test_list_filter: PASSED\n");
+}
@@ -0,0 +1,101 @@
+#include "test.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "deque.h"
+#include "printing.h"
+#include "defs.h"
+
+static int intcmp(const int *a, const int *b)
+{
+  return *a - *b;
+}
+
+void test_deque_ends()
+{
+  deque_t *dq = deque_create((cmp_fn)intcmp);
+  assert(dq != NULL);
+  assert(deque_addlast(dq, NULL) < 0);
+  assert(deque_addfirst(dq, NULL) < 0);
+
+  /* cross several block boundaries from both ends */
+  int values[1000];
+  for (int i = 0; i < 1000; i++) {
+    values[i] = i;
+  }
+  for (int i = 500; i < 1000; i++) {
+    assert(deque_addlast(dq, &values[i]) == 0);
+  }
+  for (int i = 499; i >= 0; i--) {
+    assert(deque_addfirst(dq, &values[i]) == 0);
+  }
+  assert(deque_length(dq) == 1000);
+
+  for (size_t i = 0; i < 1000; i++) {
+    assert(*(int *)deque_get(dq, i) == (int)i);
+  }
+  assert(deque_get(dq, 1000) == NULL);
+
+  int key = 777;
+  assert(deque_contains(dq, &key));
+  key = 1000;
+  assert(!deque_contains(dq, &key));
+
+  for (int i = 0; i < 300; i++) {
+    assert(*(int *)deque_popfirst(dq) == i);
+    assert(*(int *)deque_poplast(dq) == 999 - i);
+  }
+  assert(deque_length(dq) == 400);
+  assert(*(int *)deque_get(dq, 0) == 300);
+
+  while (deque_length(dq) > 0) {
+    deque_poplast(dq);
+  }
+
+  /* reuse after draining */
+  assert(deque_addfirst(dq, &values[1]) == 0);
+  assert(deque_addlast(dq, &values[2]) == 0);
+  assert(*(int *)deque_popfirst(dq) == 1);
+  assert(*(int *)deque_popfirst(dq) == 2);
+
+  deque_destroy(dq, NULL);
+  pr_info("test_deque_ends: PASSED\n");
+}
+
+void test_deque_queue()
+{
+  deque_t *dq = deque_create((cmp_fn)intcmp);
+  int values[100];
+  for (int i = 0; i < 100; i++) {
+    values[i] = i;
+    deque_addlast(dq, &values[i]);
+  }
+
+  /* steady state: memory stays flat once the ring has wrapped */
+  memstat_t before, after;
+  for (int i = 0; i < 1000; i++) {
+    deque_addlast(dq, deque_popfirst(dq));
+  }
+  deque_memstat(dq, &before);
+  for (int i = 0; i < 10000; i++) {
+    int *item = deque_popfirst(dq);
+    assert(*item == i % 100);
+    deque_addlast(dq, item);
+  }
+  deque_memstat(dq, &after);
+  assert(before.inuse == after.inuse);
+  assert(before.peak == after.peak);
+
+  for (int i = 0; i < 100; i++) {
+    deque_popfirst(dq);
+  }
+  assert(deque_length(dq) == 0);
+  for (int i = 0; i < 10; i++) {
+    int *item = malloc(sizeof *item);
+    *item = i;
+    deque_addfirst(dq, item);
+  }
+
+  deque_destroy(dq, free);
+  pr_info("test_deque_queue: PASSED\n");
+}
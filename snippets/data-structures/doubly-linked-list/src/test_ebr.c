@@ -0,0 +1,158 @@
+#include "test.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ebr.h"
+#include "printing.h"
+
+#define NTHREADS 4
+#define NSWAPS   20000
+
+static atomic_int nfreed;
+
+static void countfree(void *ptr)
+{
+  atomic_fetch_add(&nfreed, 1);
+  free(ptr);
+}
+
+/* enough rounds for the epoch to advance twice */
+static size_t settle(ebr_thread_t *thr)
+{
+  size_t pending = 0;
+  for (int i = 0; i < 4; i++) {
+    pending = ebr_collect(thr);
+  }
+  return pending;
+}
+
+void test_ebr_basic()
+{
+  ebr_t *ebr = ebr_create();
+  ebr_thread_t *thr = ebr_register(ebr);
+  ebr_thread_t *other = ebr_register(ebr);
+  atomic_store(&nfreed, 0);
+
+  // nothing holds the node back
+  ebr_retire(thr, malloc(16), countfree);
+  assert(settle(thr) == 0);
+  assert(atomic_load(&nfreed) == 1);
+
+  // the retiring thread is in a critical section, nested once
+  ebr_enter(thr);
+  ebr_enter(thr);
+  ebr_retire(thr, malloc(16), countfree);
+  ebr_exit(thr);
+  assert(settle(thr) == 1);
+  ebr_exit(thr);
+  assert(settle(thr) == 0);
+  assert(atomic_load(&nfreed) == 2);
+
+  // another thread is in a critical section
+  ebr_enter(other);
+  ebr_retire(thr, malloc(16), countfree);
+  assert(settle(thr) == 1);
+  ebr_exit(other);
+  assert(settle(thr) == 0);
+
+  // another thread holds a hazard pointer, outside a critical section
+  void *node = malloc(16);
+  ebr_protect(other, 1, node);
+  ebr_retire(thr, node, countfree);
+  assert(settle(thr) == 1);
+  ebr_unprotect(other, 1);
+  assert(settle(thr) == 0);
+  assert(atomic_load(&nfreed) == 4);
+
+  // retiring reclaims in batches without explicit collects
+  for (int i = 0; i < 10 * EBR_RETIRE_BATCH; i++) {
+    ebr_retire(thr, malloc(16), countfree);
+  }
+  assert(ebr_collect(thr) < 2 * EBR_RETIRE_BATCH);
+  assert(settle(thr) == 0);
+  assert(atomic_load(&nfreed) == 4 + 10 * EBR_RETIRE_BATCH);
+
+  // nodes of an unregistered thread are adopted by the others
+  ebr_enter(thr);
+  ebr_retire(other, malloc(16), countfree);
+  ebr_unregister(other);
+  ebr_exit(thr);
+  settle(thr);
+  assert(atomic_load(&nfreed) == 5 + 10 * EBR_RETIRE_BATCH);
+
+  // and whatever is left is freed with the domain
+  ebr_enter(thr);
+  ebr_retire(thr, malloc(16), countfree);
+  ebr_exit(thr);
+  ebr_unregister(thr);
+  ebr_destroy(ebr);
+  assert(atomic_load(&nfreed) == 6 + 10 * EBR_RETIRE_BATCH);
+
+  pr_info("test_ebr_basic: PASSED\n");
+}
+
+typedef struct node {
+  int value;
+} node_t;
+
+typedef struct shared {
+  ebr_t *ebr;
+  node_t *_Atomic slot;
+  int hazards;
+} shared_t;
+
+static void *swapper(void *arg)
+{
+  shared_t *shared = arg;
+  ebr_thread_t *thr = ebr_register(shared->ebr);
+
+  for (int i = 0; i < NSWAPS; i++) {
+    node_t *node;
+    if (shared->hazards) {
+      do {
+        node = atomic_load(&shared->slot);
+        ebr_protect(thr, 0, node);
+      } while (node != atomic_load(&shared->slot));
+      assert(node->value >= 0);
+      ebr_unprotect(thr, 0);
+    } else {
+      ebr_enter(thr);
+      node = atomic_load(&shared->slot);
+      assert(node->value >= 0);
+      ebr_exit(thr);
+    }
+
+    node_t *fresh = malloc(sizeof *fresh);
+    fresh->value = i;
+    node_t *old = atomic_exchange(&shared->slot, fresh);
+    ebr_retire(thr, old, countfree);
+  }
+
+  ebr_unregister(thr);
+  return NULL;
+}
+
+void test_ebr_threads()
+{
+  for (int hazards = 0; hazards < 2; hazards++) {
+    shared_t shared = {ebr_create(), malloc(sizeof(node_t)), hazards};
+    atomic_load(&shared.slot)->value = 0;
+    atomic_store(&nfreed, 0);
+
+    pthread_t threads[NTHREADS];
+    for (int t = 0; t < NTHREADS; t++) {
+      pthread_create(&threads[t], NULL, swapper, &shared);
+    }
+    for (int t = 0; t < NTHREADS; t++) {
+      pthread_join(threads[t], NULL);
+    }
+
+    ebr_destroy(shared.ebr);
+    assert(atomic_load(&nfreed) == NTHREADS * NSWAPS);
+    free(atomic_load(&shared.slot));
+  }
+
+  pr_info("test_ebr_threads: PASSED\n");
+}
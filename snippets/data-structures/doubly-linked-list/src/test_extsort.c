@@ -0,0 +1,151 @@
+#include "test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "extsort.h"
+#include "printing.h"
+#include "defs.h"
+
+static int intcmp(const int *a, const int *b)
+{
+  return (*a > *b) - (*a < *b);
+}
+
+static size_t encodeint(const void *item, void *buf, size_t size)
+{
+  if (size >= sizeof(int)) memcpy(buf, item, sizeof(int));
+  return sizeof(int);
+}
+
+static void *decodeint(const void *buf, size_t size)
+{
+  assert(size == sizeof(int));
+  int *item = malloc(sizeof *item);
+  if (item) memcpy(item, buf, sizeof *item);
+  return item;
+}
+
+static const extsort_codec_t intcodec = { encodeint, decodeint };
+
+/* decodes like decodeint, but fails once `decodesleft` records were decoded */
+static size_t decodesleft;
+
+static void *decodeint_failing(const void *buf, size_t size)
+{
+  if (0 == decodesleft) return NULL;
+  decodesleft--;
+  return decodeint(buf, size);
+}
+
+static const extsort_codec_t failingcodec = { encodeint, decodeint_failing };
+
+static int *newint(int value)
+{
+  int *item = malloc(sizeof *item);
+  *item = value;
+  return item;
+}
+
+/* pushes n pseudo-random ints, then checks that they come back sorted */
+static size_t sort_and_check(size_t budget, size_t n)
+{
+  extsort_t *es = extsort_create((cmp_fn)intcmp, &intcodec, budget, free);
+  assert(es != NULL);
+
+  unsigned int seed = 42;
+  long long sum = 0;
+  for (size_t i = 0; i < n; i++) {
+    int value = rand_r(&seed) % 1000;
+    sum += value;
+    assert(extsort_push(es, newint(value)) == 0);
+  }
+  assert(extsort_finish(es) == 0);
+
+  size_t count = 0;
+  int prev = -1;
+  while (extsort_hasnext(es)) {
+    int *item = extsort_next(es);
+    assert(item != NULL);
+    assert(prev <= *item);
+    prev = *item;
+    sum -= *item;
+    count++;
+    free(item);
+  }
+  assert(count == n);
+  assert(sum == 0);
+  assert(extsort_next(es) == NULL);
+
+  size_t runs = extsort_runs(es);
+  extsort_destroy(es);
+  return runs;
+}
+
+void test_extsort_inmemory()
+{
+  assert(sort_and_check(1 << 20, 1000) == 0);
+  pr_info("test_extsort_inmemory: PASSED\n");
+}
+
+void test_extsort_spill()
+{
+  /* a budget below two I/O buffers forces a fan-in of 2 and many intermediate passes */
+  assert(sort_and_check(4096, 20000) > 1);
+  assert(sort_and_check(1 << 20, 100000) > 1);
+  pr_info("test_extsort_spill: PASSED\n");
+}
+
+void test_extsort_empty()
+{
+  extsort_t *es = extsort_create((cmp_fn)intcmp, &intcodec, 4096, free);
+  assert(extsort_push(es, NULL) < 0);
+  assert(extsort_finish(es) == 0);
+  assert(extsort_finish(es) < 0);
+  assert(extsort_hasnext(es) == 0);
+  assert(extsort_next(es) == NULL);
+
+  int *late = newint(1);
+  assert(extsort_push(es, late) < 0);
+  free(late);
+  extsort_destroy(es);
+  pr_info("test_extsort_empty: PASSED\n");
+}
+
+void test_extsort_corrupt()
+{
+  unsigned int seed = 7;
+
+  /* a record of the final merge cannot be read back */
+  extsort_t *es = extsort_create((cmp_fn)intcmp, &failingcodec, 1 << 20, free);
+  for (int i = 0; i < 100000; i++) {
+    extsort_push(es, newint(rand_r(&seed) % 1000));
+  }
+  decodesleft = 50000;
+  assert(extsort_finish(es) == 0);
+  assert(extsort_runs(es) > 1);
+  assert(!extsort_error(es));
+
+  size_t count = 0;
+  while (extsort_hasnext(es)) {
+    free(extsort_next(es));
+    count++;
+  }
+  assert(count < 100000);
+  assert(extsort_error(es));
+  assert(extsort_next(es) == NULL);
+  extsort_destroy(es);
+
+  /* a record of an intermediate merge pass cannot be read back */
+  es = extsort_create((cmp_fn)intcmp, &failingcodec, 4096, free);
+  for (int i = 0; i < 20000; i++) {
+    extsort_push(es, newint(rand_r(&seed) % 1000));
+  }
+  decodesleft = 5000;
+  assert(extsort_finish(es) < 0);
+  assert(extsort_error(es));
+  assert(extsort_hasnext(es) == 0);
+  extsort_destroy(es);
+
+  pr_info("test_extsort_corrupt: PASSED\n");
+}
@@ -0,0 +1,151 @@
+#include "test.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ilist.h"
+#include "printing.h"
+#include "defs.h"
+
+static int intcmp(const int *a, const int *b)
+{
+  return (*a > *b) - (*a < *b);
+}
+
+static void check_order(ilist_t *list, int *expected, size_t n)
+{
+  ilist_iter_t *iter = ilist_createiter(list);
+  for (size_t i = 0; i < n; i++) {
+    assert(ilist_hasnext(iter));
+    assert(*(int *)ilist_next(iter) == expected[i]);
+  }
+  assert(!ilist_hasnext(iter));
+  assert(ilist_next(iter) == NULL);
+  ilist_destroyiter(iter);
+}
+
+void test_ilist_basic()
+{
+  ilist_t *list = ilist_create((cmp_fn)intcmp);
+  assert(list != NULL);
+  assert(ilist_length(list) == 0);
+  assert(ilist_addlast(list, NULL) < 0);
+
+  int values[100];
+  for (int i = 0; i < 100; i++) {
+    values[i] = i;
+  }
+
+  /* 2 1 0 3 4 */
+  ilist_addlast(list, &values[3]);
+  ilist_addfirst(list, &values[0]);
+  ilist_addfirst(list, &values[1]);
+  ilist_addfirst(list, &values[2]);
+  ilist_addlast(list, &values[4]);
+  check_order(list, (int[]){2, 1, 0, 3, 4}, 5);
+
+  assert(*(int *)ilist_popfirst(list) == 2);
+  assert(*(int *)ilist_poplast(list) == 4);
+  assert(ilist_contains(list, &values[0]));
+  assert(!ilist_contains(list, &values[4]));
+  assert(ilist_remove(list, &values[0]) == &values[0]);
+  assert(ilist_remove(list, &values[0]) == NULL);
+  check_order(list, (int[]){1, 3}, 2);
+
+  assert(*(int *)ilist_popfirst(list) == 1);
+  assert(*(int *)ilist_poplast(list) == 3);
+  assert(ilist_length(list) == 0);
+
+  /* freed nodes are reused, so churn does not grow the node array */
+  memstat_t before, after;
+  for (int i = 0; i < 100; i++) {
+    ilist_addlast(list, &values[i]);
+  }
+  ilist_memstat(list, &before);
+  for (int round = 0; round < 1000; round++) {
+    ilist_addlast(list, ilist_popfirst(list));
+    ilist_addfirst(list, ilist_poplast(list));
+    ilist_addlast(list, ilist_popfirst(list));
+  }
+  ilist_memstat(list, &after);
+  assert(after.inuse == before.inuse);
+  assert(ilist_length(list) == 100);
+
+  ilist_destroy(list, NULL);
+
+  /* items are freed on destroy */
+  list = ilist_create((cmp_fn)intcmp);
+  for (int i = 0; i < 10; i++) {
+    int *item = malloc(sizeof *item);
+    *item = i;
+    ilist_addfirst(list, item);
+  }
+  ilist_destroy(list, free);
+
+  pr_info("test_ilist_basic: PASSED\n");
+}
+
+void test_ilist_sort_compact()
+{
+  ilist_t *list = ilist_create((cmp_fn)intcmp);
+  int values[1000], sorted[1000];
+
+  srand(3);
+  for (int i = 0; i < 1000; i++) {
+    values[i] = rand() % 300;
+    sorted[i] = values[i];
+    if (i % 3) {
+      ilist_addlast(list, &values[i]);
+    } else {
+      ilist_addfirst(list, &values[i]);
+    }
+  }
+  qsort(sorted, 1000, sizeof *sorted, (cmp_fn)intcmp);
+
+  /* leave some freed nodes behind */
+  for (int i = 0; i < 100; i++) {
+    ilist_addlast(list, ilist_popfirst(list));
+  }
+  for (int i = 0; i < 50; i++) {
+    ilist_poplast(list);
+  }
+  for (int i = 0; i < 50; i++) {
+    int *item = &values[i];
+    ilist_addlast(list, item);
+  }
+
+  ilist_sort(list);
+  int *copy = malloc(1000 * sizeof *copy);
+  ilist_iter_t *iter = ilist_createiter(list);
+  for (int i = 0; i < 1000; i++) {
+    copy[i] = *(int *)ilist_next(iter);
+    assert(i == 0 || copy[i - 1] <= copy[i]);
+  }
+  ilist_destroyiter(iter);
+
+  memstat_t before, after;
+  ilist_memstat(list, &before);
+  assert(ilist_compact(list) == 0);
+  ilist_memstat(list, &after);
+  assert(after.inuse <= before.inuse);
+  check_order(list, copy, 1000);
+
+  /* still a working list after compaction */
+  assert(*(int *)ilist_poplast(list) == copy[999]);
+  ilist_addfirst(list, &values[0]);
+  ilist_addlast(list, &values[1]);
+  assert(ilist_length(list) == 1001);
+  assert(ilist_poplast(list) == &values[1]);
+  assert(ilist_popfirst(list) == &values[0]);
+  free(copy);
+
+  while (ilist_length(list) > 0) {
+    ilist_popfirst(list);
+  }
+  assert(ilist_compact(list) == 0);
+  assert(ilist_length(list) == 0);
+  ilist_addlast(list, &values[5]);
+  assert(ilist_popfirst(list) == &values[5]);
+
+  ilist_destroy(list, NULL);
+  pr_info("test_ilist_sort_compact: PASSED\n");
+}
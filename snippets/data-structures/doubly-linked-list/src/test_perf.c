@@ -0,0 +1,70 @@
+#include "test.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "perf.h"
+#include "printing.h"
+
+/* one counter group for all tests, opened by the first */
+static perf_t *perf;
+
+void test_run(const char *name, void (*test)())
+{
+  if (NULL == perf) perf = perf_create();
+  if (NULL == perf) {
+    test();
+    return;
+  }
+
+  perf_sample_t sample;
+  char counters[128];
+  perf_start(perf);
+  test();
+  perf_stop(perf, &sample);
+
+  perf_format(&sample, 0, counters, sizeof counters);
+  pr_info("%s: %.3f ms%s%s\n", name, sample.seconds * 1e3, *counters ? ", " : "", counters);
+}
+
+void test_teardown()
+{
+  perf_destroy(perf);
+  perf = NULL;
+}
+
+void test_perf()
+{
+  perf_t *p = perf_create();
+  assert(p != NULL);
+
+  perf_sample_t sample;
+  volatile uint64_t sum = 0;
+  perf_start(p);
+  for (uint64_t i = 0; i < 1000000; i++) {
+    sum += i;
+  }
+  perf_stop(p, &sample);
+
+  assert(sample.seconds > 0.0);
+  assert(sample.valid == 0 || sample.valid == perf_available(p));
+  if (sample.valid & 1u << PERF_INSTRUCTIONS) {
+    assert(sample.counts[PERF_INSTRUCTIONS] >= 1000000);
+  }
+  if (sample.valid & 1u << PERF_CYCLES) {
+    assert(sample.counts[PERF_CYCLES] > 0);
+  }
+
+  // counts are divided per element, and cut off to fit the buffer
+  char buf[128], small[8];
+  int len = perf_format(&sample, 1000000, buf, sizeof buf);
+  assert(len == (int) strlen(buf));
+  assert((0 == sample.valid) == (0 == len));
+  len = perf_format(&sample, 1000000, small, sizeof small);
+  assert(strlen(small) < sizeof small);
+  assert(len == (int) strlen(buf));
+
+  perf_destroy(p);
+  pr_info("test_perf: PASSED\n");
+}
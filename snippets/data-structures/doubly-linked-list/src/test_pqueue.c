@@ -0,0 +1,132 @@
+#include "test.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pqueue.h"
+#include "printing.h"
+#include "defs.h"
+
+static int intcmp(const int *a, const int *b)
+{
+  return (*a > *b) - (*a < *b);
+}
+
+void test_pqueue_order()
+{
+  pqueue_t *pq = pqueue_create((cmp_fn)intcmp);
+  assert(pq != NULL);
+  assert(pqueue_length(pq) == 0);
+  assert(pqueue_peek(pq) == NULL);
+  assert(pqueue_push(pq, NULL, NULL) < 0);
+
+  int values[1000];
+  srand(7);
+  for (int i = 0; i < 1000; i++) {
+    values[i] = rand() % 500;
+    assert(pqueue_push(pq, &values[i], NULL) == 0);
+  }
+  assert(pqueue_length(pq) == 1000);
+
+  int prev = -1;
+  for (int i = 0; i < 1000; i++) {
+    int *peeked = pqueue_peek(pq);
+    int *item = pqueue_pop(pq);
+    assert(item == peeked);
+    assert(*item >= prev);
+    prev = *item;
+  }
+  assert(pqueue_length(pq) == 0);
+  assert(pqueue_peek(pq) == NULL);
+
+  pqueue_destroy(pq, NULL);
+
+  /* items are freed on destroy */
+  pq = pqueue_create((cmp_fn)intcmp);
+  for (int i = 0; i < 50; i++) {
+    int *item = malloc(sizeof *item);
+    *item = 50 - i;
+    pqueue_push(pq, item, NULL);
+  }
+  assert(*(int *)pqueue_peek(pq) == 1);
+  pqueue_destroy(pq, free);
+
+  pr_info("test_pqueue_order: PASSED\n");
+}
+
+void test_pqueue_heapify()
+{
+  pqueue_t *pq = pqueue_create((cmp_fn)intcmp);
+
+  int values[777];
+  void *items[777];
+  pqueue_handle_t handles[777];
+  for (int i = 0; i < 777; i++) {
+    values[i] = (i * 389) % 777;
+    items[i] = &values[i];
+  }
+
+  /* heapify on top of pushed items */
+  for (int i = 0; i < 100; i++) {
+    pqueue_push(pq, items[i], NULL);
+  }
+  assert(pqueue_heapify(pq, &items[100], 677, &handles[100]) == 0);
+  assert(pqueue_length(pq) == 777);
+
+  items[0] = NULL;
+  assert(pqueue_heapify(pq, items, 2, NULL) < 0);
+  assert(pqueue_length(pq) == 777);
+
+  for (int i = 0; i < 777; i++) {
+    assert(*(int *)pqueue_pop(pq) == i);
+  }
+
+  assert(pqueue_heapify(pq, NULL, 0, NULL) == 0);
+  assert(pqueue_length(pq) == 0);
+
+  pqueue_destroy(pq, NULL);
+  pr_info("test_pqueue_heapify: PASSED\n");
+}
+
+void test_pqueue_decreasekey()
+{
+  pqueue_t *pq = pqueue_create((cmp_fn)intcmp);
+
+  int keys[200];
+  pqueue_handle_t handles[200];
+  for (int i = 0; i < 200; i++) {
+    keys[i] = 1000 + i;
+    assert(pqueue_push(pq, &keys[i], &handles[i]) == 0);
+  }
+
+  /* make every odd item the smallest, in reverse order */
+  for (int i = 1; i < 200; i += 2) {
+    keys[i] = -i;
+    assert(pqueue_decreasekey(pq, handles[i]) == 0);
+  }
+
+  for (int i = 199; i >= 1; i -= 2) {
+    assert(pqueue_pop(pq) == &keys[i]);
+  }
+  /* the handle of a popped item is no longer valid */
+  assert(pqueue_decreasekey(pq, handles[1]) < 0);
+  assert(pqueue_decreasekey(pq, 12345) < 0);
+
+  /* handles are reused, and stay correct for new items */
+  int extra[10];
+  pqueue_handle_t extrahandles[10];
+  for (int i = 0; i < 10; i++) {
+    extra[i] = 5000;
+    pqueue_push(pq, &extra[i], &extrahandles[i]);
+  }
+  extra[3] = 0;
+  assert(pqueue_decreasekey(pq, extrahandles[3]) == 0);
+  assert(pqueue_pop(pq) == &extra[3]);
+
+  for (int i = 0; i < 200; i += 2) {
+    assert(pqueue_pop(pq) == &keys[i]);
+  }
+  assert(pqueue_length(pq) == 9);
+
+  pqueue_destroy(pq, NULL);
+  pr_info("test_pqueue_decreasekey: PASSED\n");
+}
@@ -0,0 +1,137 @@
+#include "test.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pvec.h"
+#include "printing.h"
+
+/* enough items for a trie three levels deep */
+#define NITEMS 40000
+
+static int values[NITEMS];
+
+static void check_items(pvec_t *vec, size_t length, int offset)
+{
+  assert(pvec_length(vec) == length);
+  pvec_iter_t *iter = pvec_createiter(vec);
+  for (size_t i = 0; i < length; i++) {
+    assert(pvec_get(vec, i) == &values[(i + offset) % NITEMS]);
+    assert(pvec_next(iter) == &values[(i + offset) % NITEMS]);
+  }
+  assert(!pvec_hasnext(iter));
+  assert(pvec_next(iter) == NULL);
+  assert(pvec_get(vec, length) == NULL);
+  pvec_destroyiter(iter);
+}
+
+void test_pvec_basic()
+{
+  pvec_t *vec = pvec_create();
+  assert(vec != NULL);
+  assert(pvec_length(vec) == 0);
+  assert(pvec_addlast(vec, NULL) < 0);
+
+  for (int i = 0; i < NITEMS; i++) {
+    values[i] = i;
+    assert(pvec_addlast(vec, &values[i]) == 0);
+  }
+  check_items(vec, NITEMS, 0);
+
+  for (size_t i = 0; i < NITEMS; i++) {
+    assert(pvec_set(vec, i, &values[(i + 1) % NITEMS]) == 0);
+  }
+  assert(pvec_set(vec, NITEMS, &values[0]) < 0);
+  check_items(vec, NITEMS, 1);
+
+  // pop back through every level of the trie, and grow again
+  for (size_t i = NITEMS; i > 1000; i--) {
+    assert(pvec_poplast(vec) == &values[i % NITEMS]);
+  }
+  check_items(vec, 1000, 1);
+  for (size_t i = 1000; i < NITEMS; i++) {
+    pvec_addlast(vec, &values[(i + 1) % NITEMS]);
+  }
+  check_items(vec, NITEMS, 1);
+  while (pvec_length(vec) > 0) {
+    pvec_poplast(vec);
+  }
+  check_items(vec, 0, 0);
+
+  pvec_destroy(vec);
+  pr_info("test_pvec_basic: PASSED\n");
+}
+
+typedef struct reader {
+  pvec_t *snap;
+  size_t length;
+  int ok;
+} reader_t;
+
+static void *read_snapshot(void *arg)
+{
+  reader_t *r = arg;
+  r->ok = pvec_length(r->snap) == r->length;
+  for (size_t i = 0; i < r->length; i++) {
+    r->ok &= pvec_get(r->snap, i) == &values[i];
+  }
+  pvec_destroy(r->snap);
+  return NULL;
+}
+
+void test_pvec_snapshot()
+{
+  pvec_t *vec = pvec_create();
+  for (int i = 0; i < NITEMS; i++) {
+    values[i] = i;
+    pvec_addlast(vec, &values[i]);
+  }
+
+  // updates after a snapshot leave it unchanged, in both directions
+  pvec_t *snap = pvec_snapshot(vec);
+  pvec_set(vec, 0, &values[1]);
+  pvec_set(vec, NITEMS - 1, &values[1]);
+  pvec_poplast(vec);
+  pvec_addlast(vec, &values[2]);
+  pvec_addlast(vec, &values[3]);
+  check_items(snap, NITEMS, 0);
+  assert(pvec_get(vec, 0) == &values[1]);
+  assert(pvec_get(vec, NITEMS - 1) == &values[2]);
+  assert(pvec_get(vec, NITEMS) == &values[3]);
+
+  pvec_poplast(snap);
+  pvec_set(snap, 5, &values[0]);
+  assert(pvec_get(vec, 5) == &values[5]);
+  assert(pvec_length(vec) == NITEMS + 1);
+
+  // snapshots may be destroyed before or after the version they were taken from
+  pvec_t *snap2 = pvec_snapshot(snap);
+  pvec_destroy(snap);
+  assert(pvec_get(snap2, 5) == &values[0]);
+  pvec_destroy(vec);
+  assert(pvec_length(snap2) == NITEMS - 1);
+  pvec_destroy(snap2);
+
+  // readers on other threads drop their snapshots while the writer keeps updating
+  vec = pvec_create();
+  pthread_t threads[8];
+  reader_t readers[8];
+  for (int t = 0; t < 8; t++) {
+    for (int i = 0; i < 1000; i++) {
+      pvec_addlast(vec, &values[pvec_length(vec)]);
+    }
+    readers[t] = (reader_t) {pvec_snapshot(vec), pvec_length(vec), 0};
+    pthread_create(&threads[t], NULL, read_snapshot, &readers[t]);
+    for (size_t i = 0; i < pvec_length(vec); i += 7) {
+      pvec_set(vec, i, &values[i]);
+    }
+  }
+  for (int t = 0; t < 8; t++) {
+    pthread_join(threads[t], NULL);
+    assert(readers[t].ok);
+  }
+  pvec_destroy(vec);
+
+  pr_info("test_pvec_snapshot: PASSED\n");
+}
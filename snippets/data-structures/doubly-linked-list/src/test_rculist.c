@@ -0,0 +1,147 @@
+#include "test.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "rculist.h"
+#include "printing.h"
+#include "defs.h"
+
+#define MAGIC 0x5eed
+
+typedef struct sub {
+  int id;
+  int magic;
+} sub_t;
+
+static int subcmp(const sub_t *a, const sub_t *b)
+{
+  return a->id - b->id;
+}
+
+static void freesub(void *item)
+{
+  ((sub_t *)item)->magic = 0;
+  free(item);
+}
+
+static sub_t *newsub(int id)
+{
+  sub_t *sub = malloc(sizeof *sub);
+  sub->id = id;
+  sub->magic = MAGIC;
+  return sub;
+}
+
+void test_rculist_basic()
+{
+  rculist_t *list = rculist_create((cmp_fn)subcmp);
+  assert(list != NULL);
+  rculist_reader_t *reader = rculist_register(list);
+  assert(reader != NULL);
+
+  for (int i = 0; i < 10; i++) {
+    assert(rculist_addlast(list, newsub(i)) == 0);
+  }
+  assert(rculist_addfirst(list, newsub(-1)) == 0);
+  assert(rculist_length(list) == 11);
+
+  rculist_iter_t *iter = rculist_createiter(reader);
+  int expected = -1;
+  while (rculist_hasnext(iter)) {
+    assert(((sub_t *)rculist_next(iter))->id == expected++);
+  }
+  assert(expected == 10);
+
+  /* writers must not wait on their own online reader */
+  rculist_offline(reader);
+  sub_t key = { .id = 5 };
+  assert(rculist_remove(list, &key, freesub) == 1);
+  assert(rculist_remove(list, &key, freesub) == 0);
+  key.id = -1;
+  assert(rculist_remove(list, &key, freesub) == 1);
+  key.id = 9;
+  assert(rculist_remove(list, &key, freesub) == 1);
+  rculist_synchronize(list);
+  rculist_online(reader);
+
+  assert(rculist_length(list) == 8);
+  key.id = 5;
+  assert(!rculist_contains(reader, &key));
+  key.id = 4;
+  assert(rculist_contains(reader, &key));
+
+  rculist_resetiter(iter);
+  int count = 0;
+  while (rculist_hasnext(iter)) {
+    sub_t *sub = rculist_next(iter);
+    assert(sub->id != 5 && sub->id != 9 && sub->id != -1);
+    count++;
+  }
+  assert(count == 8);
+
+  rculist_destroyiter(iter);
+  rculist_unregister(reader);
+  rculist_destroy(list, freesub);
+  pr_info("test_rculist_basic: PASSED\n");
+}
+
+typedef struct readerarg {
+  rculist_t *list;
+  atomic_int *stop;
+} readerarg_t;
+
+static void *reader_thread(void *arg)
+{
+  readerarg_t *ra = arg;
+  rculist_reader_t *reader = rculist_register(ra->list);
+  rculist_iter_t *iter = rculist_createiter(reader);
+
+  while (!atomic_load(ra->stop)) {
+    rculist_resetiter(iter);
+    while (rculist_hasnext(iter)) {
+      sub_t *sub = rculist_next(iter);
+      assert(sub->magic == MAGIC);
+    }
+    rculist_quiescent(reader);
+  }
+
+  rculist_destroyiter(iter);
+  rculist_unregister(reader);
+  return NULL;
+}
+
+void test_rculist_concurrent()
+{
+  rculist_t *list = rculist_create((cmp_fn)subcmp);
+  for (int i = 0; i < 100; i++) {
+    rculist_addlast(list, newsub(i));
+  }
+
+  atomic_int stop = 0;
+  readerarg_t ra = { list, &stop };
+  pthread_t threads[3];
+  for (int i = 0; i < 3; i++) {
+    pthread_create(&threads[i], NULL, reader_thread, &ra);
+  }
+
+  /* churn: remove and re-add every item a few times */
+  for (int round = 0; round < 5; round++) {
+    for (int i = 0; i < 100; i++) {
+      sub_t key = { .id = i };
+      assert(rculist_remove(list, &key, freesub) == 1);
+      rculist_addlast(list, newsub(i));
+    }
+  }
+  rculist_synchronize(list);
+
+  atomic_store(&stop, 1);
+  for (int i = 0; i < 3; i++) {
+    pthread_join(threads[i], NULL);
+  }
+
+  assert(rculist_length(list) == 100);
+  rculist_destroy(list, freesub);
+  pr_info("test_rculist_concurrent: PASSED\n");
+}
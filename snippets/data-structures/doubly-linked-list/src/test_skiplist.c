@@ -0,0 +1,137 @@
+#include "test.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "skiplist.h"
+#include "printing.h"
+#include "defs.h"
+
+static int intcmp(const int *a, const int *b)
+{
+  return (*a > *b) - (*a < *b);
+}
+
+void test_skiplist_insert_contains()
+{
+  skiplist_t *sl = skiplist_create((cmp_fn)intcmp);
+  assert(sl != NULL);
+
+  int values[1000];
+  for (int i = 0; i < 1000; i++) {
+    values[i] = (i * 7919) % 1000;
+    assert(skiplist_insert(sl, &values[i]) == 0);
+  }
+  assert(skiplist_length(sl) == 1000);
+
+  /* duplicates are rejected */
+  int dup = 500;
+  assert(skiplist_insert(sl, &dup) == 1);
+  assert(skiplist_length(sl) == 1000);
+
+  for (int i = 0; i < 1000; i++) {
+    assert(skiplist_contains(sl, &i));
+    assert(*(int *)skiplist_get(sl, &i) == i);
+  }
+  int missing = 1000;
+  assert(!skiplist_contains(sl, &missing));
+  assert(*(int *)skiplist_first(sl) == 0);
+  assert(*(int *)skiplist_last(sl) == 999);
+
+  skiplist_destroy(sl, NULL);
+  pr_info("test_skiplist_insert_contains: PASSED\n");
+}
+
+void test_skiplist_remove()
+{
+  skiplist_t *sl = skiplist_create((cmp_fn)intcmp);
+  int values[100];
+  for (int i = 0; i < 100; i++) {
+    values[i] = i;
+    skiplist_insert(sl, &values[i]);
+  }
+
+  for (int i = 0; i < 100; i += 2) {
+    assert(skiplist_remove(sl, &values[i]) == &values[i]);
+  }
+  assert(skiplist_remove(sl, &values[0]) == NULL);
+  assert(skiplist_length(sl) == 50);
+
+  for (int i = 0; i < 100; i++) {
+    assert(skiplist_contains(sl, &i) == (i % 2));
+  }
+
+  /* removing the last item updates the tail */
+  int last = 99;
+  skiplist_remove(sl, &last);
+  assert(*(int *)skiplist_last(sl) == 97);
+
+  for (int i = 1; i < 99; i += 2) {
+    skiplist_remove(sl, &values[i]);
+  }
+  assert(skiplist_length(sl) == 0);
+  assert(skiplist_first(sl) == NULL);
+  assert(skiplist_last(sl) == NULL);
+
+  skiplist_destroy(sl, NULL);
+  pr_info("test_skiplist_remove: PASSED\n");
+}
+
+void test_skiplist_iter()
+{
+  skiplist_t *sl = skiplist_create((cmp_fn)intcmp);
+  for (int i = 0; i < 50; i++) {
+    int *item = malloc(sizeof *item);
+    *item = (i * 31) % 50 * 2;   /* even numbers 0..98 */
+    skiplist_insert(sl, item);
+  }
+
+  skiplist_iter_t *iter = skiplist_createiter(sl);
+  assert(!skiplist_hasprev(iter));
+  int expected = 0;
+  while (skiplist_hasnext(iter)) {
+    assert(*(int *)skiplist_next(iter) == expected);
+    expected += 2;
+  }
+  assert(expected == 100);
+  assert(skiplist_next(iter) == NULL);
+
+  /* walk backwards from the end */
+  while (skiplist_hasprev(iter)) {
+    expected -= 2;
+    assert(*(int *)skiplist_prev(iter) == expected);
+  }
+  assert(expected == 0);
+  skiplist_destroyiter(iter);
+
+  /* range scan over [11, 21) */
+  int lo = 11, hi = 21, count = 0;
+  iter = skiplist_lowerbound(sl, &lo);
+  while (skiplist_hasnext(iter)) {
+    int *item = skiplist_next(iter);
+    if (*item >= hi) break;
+    assert(*item == 12 + 2 * count);
+    count++;
+  }
+  assert(count == 5);
+  skiplist_destroyiter(iter);
+
+  int key = 40;
+  iter = skiplist_lowerbound(sl, &key);
+  assert(*(int *)skiplist_next(iter) == 40);
+  assert(*(int *)skiplist_prev(iter) == 40);
+  assert(*(int *)skiplist_prev(iter) == 38);
+  skiplist_destroyiter(iter);
+
+  iter = skiplist_upperbound(sl, &key);
+  assert(*(int *)skiplist_next(iter) == 42);
+  skiplist_destroyiter(iter);
+
+  key = 98;
+  iter = skiplist_upperbound(sl, &key);
+  assert(!skiplist_hasnext(iter));
+  assert(*(int *)skiplist_prev(iter) == 98);
+  skiplist_destroyiter(iter);
+
+  skiplist_destroy(sl, free);
+  pr_info("test_skiplist_iter: PASSED\n");
+}
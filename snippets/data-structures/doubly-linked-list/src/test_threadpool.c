@@ -0,0 +1,163 @@
+#include "test.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "list.h"
+#include "threadpool.h"
+#include "printing.h"
+#include "defs.h"
+
+typedef struct fibarg {
+  threadpool_t *pool;
+  int n;
+  long result;
+} fibarg_t;
+
+static void fib(void *arg)
+{
+  fibarg_t *f = arg;
+  if (f->n < 2) {
+    f->result = f->n;
+    return;
+  }
+
+  fibarg_t left = {f->pool, f->n - 1, 0};
+  fibarg_t right = {f->pool, f->n - 2, 0};
+  threadpool_task_t task = THREADPOOL_TASK(fib, &left);
+  threadpool_spawn(f->pool, &task);
+  fib(&right);
+  threadpool_join(f->pool, &task);
+
+  f->result = left.result + right.result;
+}
+
+void test_threadpool_fib()
+{
+  threadpool_t *pool = threadpool_create(4);
+  assert(pool != NULL);
+  assert(threadpool_nthreads(pool) == 4);
+  assert(threadpool_nthreads(NULL) == 1);
+
+  /* enough tasks to grow the deques, run several times on the same pool */
+  for (int i = 0; i < 3; i++) {
+    fibarg_t arg = {pool, 20, 0};
+    threadpool_run(pool, fib, &arg);
+    assert(arg.result == 6765);
+  }
+
+  /* without a pool, and with a single thread */
+  fibarg_t arg = {NULL, 15, 0};
+  threadpool_run(NULL, fib, &arg);
+  assert(arg.result == 610);
+  threadpool_destroy(pool);
+
+  pool = threadpool_create(1);
+  arg = (fibarg_t){pool, 15, 0};
+  threadpool_run(pool, fib, &arg);
+  assert(arg.result == 610);
+  threadpool_destroy(pool);
+
+  pr_info("test_threadpool_fib: PASSED\n");
+}
+
+static int intcmp(const int *a, const int *b)
+{
+  return (*a > *b) - (*a < *b);
+}
+
+static void count(void *item, atomic_long *sum)
+{
+  atomic_fetch_add(sum, *(int *)item);
+}
+
+static void *square(void *item, int *squares)
+{
+  int i = *(int *)item;
+  squares[i] = i * i;
+  return &squares[i];
+}
+
+static int iseven(void *item, void *ctx)
+{
+  (void)ctx;
+  return *(int *)item % 2 == 0;
+}
+
+/* polynomial hash of the items in order: associative, but not commutative */
+typedef struct polyhash {
+  uint64_t hash;
+  uint64_t pow;
+} polyhash_t;
+
+static void fold(polyhash_t *acc, void *item, void *ctx)
+{
+  (void)ctx;
+  acc->hash = acc->hash * 31 + *(int *)item;
+  acc->pow *= 31;
+}
+
+static void combine(polyhash_t *acc, polyhash_t *other, void *ctx)
+{
+  (void)ctx;
+  acc->hash = acc->hash * other->pow + other->hash;
+  acc->pow *= other->pow;
+}
+
+static void check_parallel(threadpool_t *pool, list_t *list, int n)
+{
+  static int squares[10000];
+
+  atomic_long sum = 0;
+  assert(list_foreach(pool, list, (list_foreach_fn)count, &sum) == 0);
+  assert(sum == (long)n * (n - 1) / 2);
+
+  list_t *mapped = list_map(pool, list, (list_map_fn)square, squares, (cmp_fn)intcmp);
+  assert(mapped != NULL && list_length(mapped) == (size_t)n);
+  list_iter_t *iter = list_createiter(mapped);
+  for (int i = 0; i < n; i++) {
+    assert(*(int *)list_next(iter) == i * i);
+  }
+  list_destroyiter(iter);
+  list_destroy(mapped, NULL);
+
+  list_t *evens = list_filter(pool, list, iseven, NULL);
+  assert(evens != NULL && list_length(evens) == (size_t)(n + 1) / 2);
+  iter = list_createiter(evens);
+  for (int i = 0; i < n; i += 2) {
+    assert(*(int *)list_next(iter) == i);
+  }
+  list_destroyiter(iter);
+  list_destroy(evens, NULL);
+
+  polyhash_t expected = {0, 1};
+  for (int i = 0; i < n; i++) {
+    fold(&expected, &i, NULL);
+  }
+  polyhash_t acc = {0, 1};
+  assert(list_reduce(pool, list, (list_reduce_fn)fold, (list_reduce_fn)combine, &acc, sizeof acc, NULL) == 0);
+  assert(acc.hash == expected.hash && acc.pow == expected.pow);
+}
+
+void test_list_parallel()
+{
+  static int values[10000];
+  threadpool_t *pool = threadpool_create(4);
+  const int sizes[] = {0, 1, 7, 100, 10000};
+
+  for (size_t s = 0; s < sizeof sizes / sizeof *sizes; s++) {
+    list_t *list = list_create((cmp_fn)intcmp);
+    for (int i = 0; i < sizes[s]; i++) {
+      values[i] = i;
+      list_addlast(list, &values[i]);
+    }
+
+    check_parallel(pool, list, sizes[s]);
+    check_parallel(NULL, list, sizes[s]);
+    list_destroy(list, NULL);
+  }
+
+  threadpool_destroy(pool);
+  pr_info("test_list_parallel: PASSED\n");
+}
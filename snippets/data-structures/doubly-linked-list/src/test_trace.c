@@ -0,0 +1,100 @@
+#include "test.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "list.h"
+#include "trace.h"
+#include "printing.h"
+#include "defs.h"
+
+#ifdef TRACING
+
+static size_t count(const char *haystack, const char *needle)
+{
+  size_t n = 0;
+  for (const char *p = strstr(haystack, needle); NULL != p; p = strstr(p + 1, needle)) {
+    n++;
+  }
+  return n;
+}
+
+static void *worker(void *arg)
+{
+  (void)arg;
+  for (int i = 0; i < 5000; i++) {
+    TRACE_SCOPE("worker");
+  }
+  return NULL;
+}
+
+static int intcmp(const int *a, const int *b)
+{
+  return (*a > *b) - (*a < *b);
+}
+
+void test_trace()
+{
+  {
+    TRACE_SCOPE("outer");
+    TRACE_BEGIN("inner \"quoted\"");
+    TRACE_END();
+  }
+
+  /* spans of the library, and of a thread that has exited, across several chunks */
+  int values[3] = {3, 1, 2};
+  list_t *list = list_create((cmp_fn)intcmp);
+  for (int i = 0; i < 3; i++) {
+    list_addlast(list, &values[i]);
+  }
+  list_sort(list);
+  list_remove(list, &values[0]);
+  list_destroy(list, NULL);
+
+  pthread_t thread;
+  pthread_create(&thread, NULL, worker, NULL);
+  pthread_join(thread, NULL);
+
+  char path[] = "/tmp/trace-XXXXXX";
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+  assert(TRACE_EXPORT(path) == 0);
+
+  FILE *f = fdopen(fd, "r");
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  rewind(f);
+  char *json = malloc(size + 1);
+  assert(fread(json, 1, size, f) == (size_t)size);
+  json[size] = '\0';
+  fclose(f);
+  remove(path);
+
+  assert(strncmp(json, "{\"traceEvents\":[", 16) == 0);
+  /* earlier tests add spans too, e.g. of list_sort */
+  assert(count(json, "\"ph\":\"B\"") >= 5004);
+  assert(count(json, "\"ph\":\"B\"") == count(json, "\"ph\":\"E\""));
+  assert(count(json, "\"name\":\"worker\"") == 5000);
+  assert(count(json, "\"name\":\"outer\"") == 1);
+  assert(count(json, "\"name\":\"inner \\\"quoted\\\"\"") == 1);
+  assert(count(json, "\"name\":\"list_sort\"") >= 1);
+  assert(count(json, "\"name\":\"list_remove\"") >= 1);
+  free(json);
+  pr_info("test_trace: PASSED\n");
+}
+
+#else
+
+void test_trace()
+{
+  /* without TRACING the macros are no-ops */
+  TRACE_SCOPE("unused");
+  TRACE_BEGIN("unused");
+  TRACE_END();
+  assert(TRACE_EXPORT("/nonexistent/trace.json") == 0);
+
+  pr_info("test_trace: PASSED (TRACING not defined)\n");
+}
+
+#endif /* TRACING */
@@ -0,0 +1,185 @@
+#include "test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vec.h"
+#include "pdqsort.h"
+#include "printing.h"
+#include "defs.h"
+
+static int intcmp(const int *a, const int *b)
+{
+  return (*a > *b) - (*a < *b);
+}
+
+VEC_DEFINE(intvec, int)
+
+typedef struct big {
+  int key;
+  char pad[100];
+} big_t;
+
+static int bigcmp(const big_t *a, const big_t *b)
+{
+  return intcmp(&a->key, &b->key);
+}
+
+void test_vec_basic()
+{
+  vec_t *vec = vec_create((cmp_fn)intcmp);
+  assert(vec != NULL);
+  assert(vec_length(vec) == 0);
+  assert(vec_get(vec, 0) == NULL);
+
+  int values[100];
+  for (int i = 0; i < 100; i++) {
+    values[i] = i;
+    assert(vec_addlast(vec, &values[i]) == 0);
+  }
+  assert(vec_addlast(vec, NULL) < 0);
+  assert(vec_length(vec) == 100);
+  assert(*(int *)vec_get(vec, 42) == 42);
+  assert(vec_get(vec, 100) == NULL);
+  assert(vec_items(vec)[7] == &values[7]);
+
+  int key = 50;
+  assert(vec_contains(vec, &key));
+  assert(vec_remove(vec, &key) == &values[50]);
+  assert(!vec_contains(vec, &key));
+  assert(vec_remove(vec, &key) == NULL);
+  assert(vec_length(vec) == 99);
+  assert(*(int *)vec_get(vec, 50) == 51);
+
+  assert(*(int *)vec_poplast(vec) == 99);
+  assert(vec_length(vec) == 98);
+
+  memstat_t stat;
+  vec_memstat(vec, &stat);
+  assert(stat.inuse > 98 * sizeof(void *) && stat.peak >= stat.inuse);
+
+  vec_destroy(vec, NULL);
+  pr_info("test_vec_basic: PASSED\n");
+}
+
+static int is_sorted(int *a, size_t n)
+{
+  for (size_t i = 1; i < n; i++) {
+    if (a[i - 1] > a[i]) return 0;
+  }
+  return 1;
+}
+
+void test_pdqsort()
+{
+  size_t n = 10000;
+  int *a = malloc(n * sizeof *a);
+  unsigned int seed = 7;
+
+  /* random, sorted, reversed, all equal, few distinct, sawtooth, organ pipe */
+  for (int pattern = 0; pattern < 7; pattern++) {
+    long long sum = 0;
+    for (size_t i = 0; i < n; i++) {
+      switch (pattern) {
+        case 0: a[i] = rand_r(&seed); break;
+        case 1: a[i] = i; break;
+        case 2: a[i] = n - i; break;
+        case 3: a[i] = 5; break;
+        case 4: a[i] = rand_r(&seed) % 4; break;
+        case 5: a[i] = i % 100; break;
+        default: a[i] = i < n / 2 ? i : n - i; break;
+      }
+      sum += a[i];
+    }
+    pdqsort(a, n, sizeof *a, (cmp_fn)intcmp);
+    assert(is_sorted(a, n));
+    for (size_t i = 0; i < n; i++) {
+      sum -= a[i];
+    }
+    assert(sum == 0);
+  }
+
+  /* small inputs */
+  for (size_t len = 0; len < 40; len++) {
+    for (size_t i = 0; i < len; i++) {
+      a[i] = rand_r(&seed) % 10;
+    }
+    pdqsort(a, len, sizeof *a, (cmp_fn)intcmp);
+    assert(is_sorted(a, len));
+  }
+  free(a);
+
+  /* elements larger than the stack scratch space */
+  big_t *b = malloc(1000 * sizeof *b);
+  for (int i = 0; i < 1000; i++) {
+    b[i].key = rand_r(&seed) % 500;
+    memset(b[i].pad, b[i].key & 0x7f, sizeof b[i].pad);
+  }
+  pdqsort(b, 1000, sizeof *b, (cmp_fn)bigcmp);
+  for (int i = 0; i < 1000; i++) {
+    assert(i == 0 || b[i - 1].key <= b[i].key);
+    assert(b[i].pad[99] == (b[i].key & 0x7f));
+  }
+  free(b);
+  pr_info("test_pdqsort: PASSED\n");
+}
+
+void test_vec_sort_bsearch()
+{
+  vec_t *vec = vec_create((cmp_fn)intcmp);
+  int values[1000];
+  unsigned int seed = 3;
+  for (int i = 0; i < 1000; i++) {
+    values[i] = (rand_r(&seed) % 1000) * 2;   /* even numbers only */
+    vec_addlast(vec, &values[i]);
+  }
+
+  vec_sort(vec);
+  for (size_t i = 1; i < vec_length(vec); i++) {
+    assert(*(int *)vec_get(vec, i - 1) <= *(int *)vec_get(vec, i));
+  }
+
+  size_t index;
+  for (int i = 0; i < 1000; i++) {
+    assert(vec_bsearch(vec, &values[i], &index));
+    assert(*(int *)vec_get(vec, index) == values[i]);
+    assert(index == 0 || *(int *)vec_get(vec, index - 1) < values[i]);
+  }
+
+  int odd = 1;
+  assert(!vec_bsearch(vec, &odd, &index));
+  assert(*(int *)vec_get(vec, index) > odd);
+  assert(index == 0 || *(int *)vec_get(vec, index - 1) < odd);
+
+  int big = 5000;
+  assert(!vec_bsearch(vec, &big, &index));
+  assert(index == vec_length(vec));
+
+  vec_destroy(vec, NULL);
+  pr_info("test_vec_sort_bsearch: PASSED\n");
+}
+
+void test_vec_typed()
+{
+  intvec_t v;
+  intvec_init(&v);
+  for (int i = 0; i < 100; i++) {
+    assert(intvec_addlast(&v, 99 - i) == 0);
+  }
+  assert(v.length == 100);
+  assert(*intvec_get(&v, 0) == 99);
+  assert(intvec_get(&v, 100) == NULL);
+
+  int key = 10;
+  assert(intvec_contains(&v, &key, intcmp));
+  intvec_sort(&v, intcmp);
+  assert(is_sorted(v.data, v.length));
+
+  size_t index;
+  assert(intvec_bsearch(&v, &key, intcmp, &index) && index == 10);
+  assert(intvec_poplast(&v) == 99);
+
+  intvec_free(&v);
+  assert(v.length == 0);
+  pr_info("test_vec_typed: PASSED\n");
+}
@@ -0,0 +1,344 @@
+#include "printing.h"
+#include "threadpool.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define DEQUE_MINCAP 64
+#define CACHELINE 64
+
+
+/*
+ * Chase–Lev work-stealing deque, with the memory orderings of Lê et al., "Correct and
+ * Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013). The owner pushes and takes at
+ * the bottom, thieves steal at the top. Arrays replaced by growth may still be read by a
+ * thief, so they are kept until the pool is destroyed.
+ */
+typedef struct taskarray taskarray_t;
+struct taskarray {
+  taskarray_t *prev;    /* replaced arrays */
+  int64_t capacity;     /* power of two */
+  _Atomic(threadpool_task_t *) tasks[];
+};
+
+typedef struct taskdeque {
+  _Alignas(CACHELINE) atomic_int_least64_t top;
+  _Alignas(CACHELINE) atomic_int_least64_t bottom;
+  _Atomic(taskarray_t *) array;
+} taskdeque_t;
+
+struct threadpool {
+  taskdeque_t *deques;  /* one per thread, 0 belongs to the caller of threadpool_run */
+  pthread_t *workers;   /* 1 ... nstarted, 0 is unused */
+  size_t nthreads;
+  size_t nstarted;
+  pthread_mutex_t runlock;
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  atomic_int active;    /* a run is in progress */
+  int shutdown;
+};
+
+typedef struct worker {
+  threadpool_t *pool;
+  size_t index;
+} worker_t;
+
+/* the pool whose run the calling thread takes part in, and its deque */
+static _Thread_local threadpool_t *curpool;
+static _Thread_local size_t curindex;
+static _Thread_local uint64_t rngstate;
+
+
+static taskarray_t *newarray(int64_t capacity) {
+  taskarray_t *array = malloc(sizeof *array + capacity * sizeof array->tasks[0]);
+  if (NULL == array) {
+    pr_error("Failed to allocate task deque\n");
+    return NULL;
+  }
+
+  array->prev = NULL;
+  array->capacity = capacity;
+  return array;
+}
+
+static int deque_init(taskdeque_t *dq) {
+  taskarray_t *array = newarray(DEQUE_MINCAP);
+  if (NULL == array) return -1;
+
+  atomic_init(&dq->top, 0);
+  atomic_init(&dq->bottom, 0);
+  atomic_init(&dq->array, array);
+  return 0;
+}
+
+static void deque_free(taskdeque_t *dq) {
+  taskarray_t *array = atomic_load_explicit(&dq->array, memory_order_relaxed);
+  while (NULL != array) {
+    taskarray_t *prev = array->prev;
+    free(array);
+    array = prev;
+  }
+}
+
+/* owner only. Returns -1 if the deque is full and cannot grow */
+static int deque_push(taskdeque_t *dq, threadpool_task_t *task) {
+  int64_t b = atomic_load_explicit(&dq->bottom, memory_order_relaxed);
+  int64_t t = atomic_load_explicit(&dq->top, memory_order_acquire);
+  taskarray_t *array = atomic_load_explicit(&dq->array, memory_order_relaxed);
+
+  if (b - t > array->capacity - 1) {
+    taskarray_t *grown = newarray(2 * array->capacity);
+    if (NULL == grown) return -1;
+
+    for (int64_t i = t; i < b; i++) {
+      threadpool_task_t *old = atomic_load_explicit(&array->tasks[i & (array->capacity - 1)],
+                                                    memory_order_relaxed);
+      atomic_store_explicit(&grown->tasks[i & (grown->capacity - 1)], old, memory_order_relaxed);
+    }
+    grown->prev = array;
+    atomic_store_explicit(&dq->array, grown, memory_order_release);
+    array = grown;
+  }
+
+  // a release store rather than the paper's release fence, which thread sanitizers understand
+  atomic_store_explicit(&array->tasks[b & (array->capacity - 1)], task, memory_order_relaxed);
+  atomic_store_explicit(&dq->bottom, b + 1, memory_order_release);
+  return 0;
+}
+
+/* owner only */
+static threadpool_task_t *deque_take(taskdeque_t *dq) {
+  int64_t b = atomic_load_explicit(&dq->bottom, memory_order_relaxed) - 1;
+  taskarray_t *array = atomic_load_explicit(&dq->array, memory_order_relaxed);
+  atomic_store_explicit(&dq->bottom, b, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  int64_t t = atomic_load_explicit(&dq->top, memory_order_relaxed);
+
+  if (t > b) {
+    atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+    return NULL;
+  }
+
+  threadpool_task_t *task = atomic_load_explicit(&array->tasks[b & (array->capacity - 1)],
+                                                 memory_order_relaxed);
+  if (t == b) {
+    // last task, race thieves for it
+    if (!atomic_compare_exchange_strong_explicit(&dq->top, &t, t + 1, memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+      task = NULL;
+    }
+    atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+  }
+
+  return task;
+}
+
+/* any thread. Returns NULL if the deque is empty or another thread won the race */
+static threadpool_task_t *deque_steal(taskdeque_t *dq) {
+  int64_t t = atomic_load_explicit(&dq->top, memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  int64_t b = atomic_load_explicit(&dq->bottom, memory_order_acquire);
+
+  if (t >= b) return NULL;
+
+  taskarray_t *array = atomic_load_explicit(&dq->array, memory_order_acquire);
+  threadpool_task_t *task = atomic_load_explicit(&array->tasks[t & (array->capacity - 1)],
+                                                 memory_order_relaxed);
+  if (!atomic_compare_exchange_strong_explicit(&dq->top, &t, t + 1, memory_order_seq_cst,
+                                               memory_order_relaxed)) {
+    return NULL;
+  }
+
+  return task;
+}
+
+
+static void runtask(threadpool_task_t *task) {
+  task->fn(task->arg);
+  atomic_store_explicit(&task->done, 1, memory_order_release);
+}
+
+/* Takes from the own deque first, then tries the others from a random starting point */
+static threadpool_task_t *findtask(threadpool_t *pool) {
+  threadpool_task_t *task = deque_take(&pool->deques[curindex]);
+  if (NULL != task) return task;
+
+  rngstate ^= rngstate << 13;
+  rngstate ^= rngstate >> 7;
+  rngstate ^= rngstate << 17;
+
+  size_t start = rngstate % pool->nthreads;
+  for (size_t i = 0; i < pool->nthreads; i++) {
+    size_t victim = (start + i) % pool->nthreads;
+    if (victim == curindex) continue;
+
+    task = deque_steal(&pool->deques[victim]);
+    if (NULL != task) return task;
+  }
+
+  return NULL;
+}
+
+static void *workerloop(void *arg) {
+  worker_t *worker = arg;
+  threadpool_t *pool = worker->pool;
+  curpool = pool;
+  curindex = worker->index;
+  rngstate = 0x9E3779B97F4A7C15ULL * (worker->index + 1);
+  free(worker);
+
+  for (;;) {
+    // sleep between runs, and spin while one is in progress
+    if (!atomic_load_explicit(&pool->active, memory_order_acquire)) {
+      pthread_mutex_lock(&pool->lock);
+      while (!pool->shutdown && !atomic_load_explicit(&pool->active, memory_order_relaxed)) {
+        pthread_cond_wait(&pool->wake, &pool->lock);
+      }
+      int shutdown = pool->shutdown;
+      pthread_mutex_unlock(&pool->lock);
+      if (shutdown) break;
+    }
+
+    threadpool_task_t *task = findtask(pool);
+    if (NULL != task) {
+      runtask(task);
+    } else {
+      sched_yield();
+    }
+  }
+
+  return NULL;
+}
+
+
+threadpool_t *threadpool_create(size_t nthreads) {
+  if (0 == nthreads) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = ncpu > 0 ? (size_t) ncpu : 1;
+  }
+
+  threadpool_t *pool = malloc(sizeof *pool);
+  if (NULL == pool) {
+    pr_error("Failed to allocate memory for thread pool\n");
+    return NULL;
+  }
+
+  pool->deques = aligned_alloc(CACHELINE, nthreads * sizeof *pool->deques);
+  pool->workers = malloc(nthreads * sizeof *pool->workers);
+  if (NULL == pool->deques || NULL == pool->workers) {
+    pr_error("Failed to allocate memory for thread pool\n");
+    free(pool->deques);
+    free(pool->workers);
+    free(pool);
+    return NULL;
+  }
+
+  pool->nthreads = 0;
+  pool->nstarted = 0;
+  pthread_mutex_init(&pool->runlock, NULL);
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->wake, NULL);
+  atomic_init(&pool->active, 0);
+  pool->shutdown = 0;
+
+  for (size_t i = 0; i < nthreads; i++) {
+    if (deque_init(&pool->deques[i]) < 0) {
+      threadpool_destroy(pool);
+      return NULL;
+    }
+    pool->nthreads += 1;
+  }
+
+  // thread 0 is the caller of threadpool_run
+  for (size_t i = 1; i < nthreads; i++) {
+    worker_t *worker = malloc(sizeof *worker);
+    if (NULL != worker) {
+      worker->pool = pool;
+      worker->index = i;
+    }
+    if (NULL == worker || 0 != pthread_create(&pool->workers[i], NULL, workerloop, worker)) {
+      pr_error("Failed to start worker thread %zu\n", i);
+      free(worker);
+      threadpool_destroy(pool);
+      return NULL;
+    }
+    pool->nstarted = i;
+  }
+
+  return pool;
+}
+
+void threadpool_destroy(threadpool_t *pool) {
+  if (NULL == pool) return;
+
+  pthread_mutex_lock(&pool->lock);
+  pool->shutdown = 1;
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->lock);
+
+  for (size_t i = 1; i <= pool->nstarted; i++) {
+    pthread_join(pool->workers[i], NULL);
+  }
+  for (size_t i = 0; i < pool->nthreads; i++) {
+    deque_free(&pool->deques[i]);
+  }
+
+  pthread_mutex_destroy(&pool->runlock);
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->wake);
+  free(pool->deques);
+  free(pool->workers);
+  free(pool);
+}
+
+size_t threadpool_nthreads(threadpool_t *pool) { return NULL == pool ? 1 : pool->nthreads; }
+
+void threadpool_run(threadpool_t *pool, task_fn fn, void *arg) {
+  if (NULL == pool || curpool == pool || 1 == pool->nthreads) {
+    fn(arg);
+    return;
+  }
+
+  pthread_mutex_lock(&pool->runlock);
+  threadpool_t *prevpool = curpool;
+  size_t previndex = curindex;
+  curpool = pool;
+  curindex = 0;
+  if (0 == rngstate) rngstate = 0x2545F4914F6CDD1DULL;
+
+  pthread_mutex_lock(&pool->lock);
+  atomic_store_explicit(&pool->active, 1, memory_order_release);
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->lock);
+
+  // every task spawned below the root is joined before the root returns
+  fn(arg);
+
+  atomic_store_explicit(&pool->active, 0, memory_order_release);
+  curpool = prevpool;
+  curindex = previndex;
+  pthread_mutex_unlock(&pool->runlock);
+}
+
+void threadpool_spawn(threadpool_t *pool, threadpool_task_t *task) {
+  if (NULL == pool || curpool != pool || deque_push(&pool->deques[curindex], task) < 0) {
+    runtask(task);
+  }
+}
+
+void threadpool_join(threadpool_t *pool, threadpool_task_t *task) {
+  while (!atomic_load_explicit(&task->done, memory_order_acquire)) {
+    // the task is in the own deque unless stolen, and if stolen, help with other work
+    threadpool_task_t *other = NULL != pool && curpool == pool ? findtask(pool) : NULL;
+    if (NULL != other) {
+      runtask(other);
+    } else {
+      sched_yield();
+    }
+  }
+}
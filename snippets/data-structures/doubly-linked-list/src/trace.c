@@ -0,0 +1,212 @@
+#include "trace.h"
+
+#ifdef TRACING
+
+#include "printing.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+
+/* begin events carry the span name, end events a NULL name */
+typedef struct event {
+  const char *name;
+  uint64_t ticks;
+} event_t;
+
+typedef struct chunk chunk_t;
+struct chunk {
+  chunk_t *next;
+  size_t count;
+  event_t events[TRACE_CHUNKSIZE];
+};
+
+/* Events of one thread. Buffers outlive their thread, so spans of exited threads are exported */
+typedef struct tracebuf tracebuf_t;
+struct tracebuf {
+  tracebuf_t *next;
+  pid_t tid;
+  chunk_t *head;
+  chunk_t *tail;
+};
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static tracebuf_t *buffers;
+static _Thread_local tracebuf_t *self;
+
+/* ticks and wall-clock time when the first buffer was created, to convert ticks at export */
+static uint64_t startticks;
+static double startns;
+
+
+static inline uint64_t ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+static double wallns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+static chunk_t *newchunk(void) {
+  chunk_t *chunk = malloc(sizeof *chunk);
+  if (NULL == chunk) {
+    pr_error("Failed to allocate trace buffer\n");
+    return NULL;
+  }
+
+  chunk->next = NULL;
+  chunk->count = 0;
+  return chunk;
+}
+
+static tracebuf_t *getbuf(void) {
+  if (NULL != self) return self;
+
+  tracebuf_t *buf = malloc(sizeof *buf);
+  if (NULL == buf) {
+    pr_error("Failed to allocate trace buffer\n");
+    return NULL;
+  }
+
+  buf->head = newchunk();
+  if (NULL == buf->head) {
+    free(buf);
+    return NULL;
+  }
+  buf->tail = buf->head;
+  buf->tid = gettid();
+
+  pthread_mutex_lock(&lock);
+  if (NULL == buffers) {
+    startticks = ticks();
+    startns = wallns();
+  }
+  buf->next = buffers;
+  buffers = buf;
+  pthread_mutex_unlock(&lock);
+
+  self = buf;
+  return buf;
+}
+
+static void record(const char *name) {
+  tracebuf_t *buf = getbuf();
+  if (NULL == buf) return;
+
+  chunk_t *chunk = buf->tail;
+  if (TRACE_CHUNKSIZE == chunk->count) {
+    chunk = newchunk();
+    if (NULL == chunk) return;
+    buf->tail->next = chunk;
+    buf->tail = chunk;
+  }
+
+  event_t *event = &chunk->events[chunk->count++];
+  event->name = name;
+  event->ticks = ticks();
+}
+
+/* span names are expected to be identifiers, but keep the JSON valid regardless */
+static void putname(FILE *f, const char *name) {
+  fputc('"', f);
+  for (const char *c = name; '\0' != *c; c++) {
+    if ('"' == *c || '\\' == *c) {
+      fputc('\\', f);
+      fputc(*c, f);
+    } else if ((unsigned char) *c >= 0x20) {
+      fputc(*c, f);
+    }
+  }
+  fputc('"', f);
+}
+
+
+void trace_begin(const char *name) { record(name); }
+
+void trace_end(void) { record(NULL); }
+
+int trace_export(const char *path) {
+  FILE *f = fopen(path, "w");
+  if (NULL == f) {
+    pr_error("Failed to open trace file %s\n", path);
+    return -1;
+  }
+
+  pthread_mutex_lock(&lock);
+
+  // calibrate ticks against the wall clock over the whole traced period
+  uint64_t endticks = ticks();
+  double nspertick = 1.0;
+  if (endticks > startticks) nspertick = (wallns() - startns) / (double) (endticks - startticks);
+
+  int pid = getpid();
+  const char *sep = "";
+  fprintf(f, "{\"traceEvents\":[\n");
+
+  for (tracebuf_t *buf = buffers; NULL != buf; buf = buf->next) {
+    for (chunk_t *chunk = buf->head; NULL != chunk; chunk = chunk->next) {
+      for (size_t i = 0; i < chunk->count; i++) {
+        event_t *event = &chunk->events[i];
+        double us = (double) (event->ticks - startticks) * nspertick / 1e3;
+
+        fprintf(f, "%s{", sep);
+        if (NULL != event->name) {
+          fprintf(f, "\"name\":");
+          putname(f, event->name);
+          fprintf(f, ",\"ph\":\"B\"");
+        } else {
+          fprintf(f, "\"ph\":\"E\"");
+        }
+        fprintf(f, ",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}", us, pid, (int) buf->tid);
+        sep = ",\n";
+      }
+    }
+  }
+
+  fprintf(f, "\n],\"displayTimeUnit\":\"ns\"}\n");
+  pthread_mutex_unlock(&lock);
+
+  if (0 != fclose(f)) {
+    pr_error("Failed to write trace file %s\n", path);
+    return -1;
+  }
+
+  return 0;
+}
+
+void trace_reset(void) {
+  pthread_mutex_lock(&lock);
+
+  for (tracebuf_t *buf = buffers; NULL != buf; buf = buf->next) {
+    chunk_t *chunk = buf->head->next;
+    while (NULL != chunk) {
+      chunk_t *next = chunk->next;
+      free(chunk);
+      chunk = next;
+    }
+
+    buf->head->next = NULL;
+    buf->head->count = 0;
+    buf->tail = buf->head;
+  }
+
+  pthread_mutex_unlock(&lock);
+}
+
+#endif /* TRACING */
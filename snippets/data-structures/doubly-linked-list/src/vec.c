@@ -0,0 +1,152 @@
+#include "alloc.h"
+#include "defs.h"
+#include "pdqsort.h"
+#include "printing.h"
+#include "vec.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define VEC_MINCAP 8
+
+
+struct vec {
+  void **items;
+  size_t length;
+  size_t capacity;
+  cmp_fn cmpfn;
+  allocator_t allocator;
+  memstat_t mem;
+};
+
+
+vec_t *vec_create(cmp_fn cmpfn) { return vec_create_with_allocator(cmpfn, NULL); }
+
+vec_t *vec_create_with_allocator(cmp_fn cmpfn, const allocator_t *allocator) {
+  if (NULL == cmpfn) {
+    pr_error("Failed compare function not given\n");
+    return NULL;
+  }
+  if (NULL == allocator) allocator = &stdlib_allocator;
+
+  vec_t *vec = allocator->alloc(allocator->ctx, sizeof *vec);
+  if (NULL == vec) {
+    pr_error("Failed to allocate memory for vec\n");
+    return NULL;
+  }
+
+  vec->items = NULL;
+  vec->length = 0;
+  vec->capacity = 0;
+  vec->cmpfn = cmpfn;
+  vec->allocator = *allocator;
+  vec->mem.inuse = sizeof *vec;
+  vec->mem.peak = sizeof *vec;
+
+  return vec;
+}
+
+void vec_destroy(vec_t *vec, free_fn item_free) {
+  if (NULL == vec) return;
+
+  if (NULL != item_free) {
+    for (size_t i = 0; i < vec->length; i++) {
+      item_free(vec->items[i]);
+    }
+  }
+
+  mem_free(&vec->allocator, &vec->mem, vec->items, vec->capacity * sizeof *vec->items);
+  allocator_t allocator = vec->allocator;
+  allocator.free(allocator.ctx, vec, sizeof *vec);
+}
+
+size_t vec_length(vec_t *vec) { return vec->length; }
+
+void vec_memstat(vec_t *vec, memstat_t *stat) { *stat = vec->mem; }
+
+int vec_reserve(vec_t *vec, size_t capacity) {
+  if (capacity <= vec->capacity) return 0;
+
+  void **items = mem_realloc(&vec->allocator, &vec->mem, vec->items,
+                             vec->capacity * sizeof *items, capacity * sizeof *items);
+  if (NULL == items) {
+    pr_error("Failed to grow vec to %zu items\n", capacity);
+    return -1;
+  }
+
+  vec->items = items;
+  vec->capacity = capacity;
+  return 0;
+}
+
+int vec_addlast(vec_t *vec, void *item) {
+  if (NULL == vec || NULL == item) {
+    pr_error("Vec parameter and item parameter not given\n");
+    return -1;
+  }
+
+  if (vec->length == vec->capacity) {
+    size_t capacity = vec->capacity ? vec->capacity * 2 : VEC_MINCAP;
+    if (vec_reserve(vec, capacity) < 0) return -1;
+  }
+
+  vec->items[vec->length++] = item;
+  return 0;
+}
+
+void *vec_poplast(vec_t *vec) {
+  if (NULL == vec || 0 == vec->length) PANIC("Vec is empty, PANICING(exiting)\n");
+
+  return vec->items[--vec->length];
+}
+
+void *vec_get(vec_t *vec, size_t index) {
+  if (NULL == vec || index >= vec->length) return NULL;
+
+  return vec->items[index];
+}
+
+void **vec_items(vec_t *vec) { return vec->items; }
+
+void *vec_remove(vec_t *vec, void *item) {
+  if (NULL == vec || NULL == item) return NULL;
+
+  for (size_t i = 0; i < vec->length; i++) {
+    if (vec->cmpfn(vec->items[i], item) == 0) {
+      void *returnData = vec->items[i];
+      memmove(&vec->items[i], &vec->items[i + 1], (vec->length - i - 1) * sizeof *vec->items);
+      vec->length -= 1;
+      return returnData;
+    }
+  }
+
+  return NULL;
+}
+
+int vec_contains(vec_t *vec, void *item) {
+  for (size_t i = 0; i < vec->length; i++) {
+    if (vec->cmpfn(vec->items[i], item) == 0) return 1;
+  }
+
+  return 0;
+}
+
+void vec_sort(vec_t *vec) { pdqsort_items(vec->items, vec->length, vec->cmpfn); }
+
+int vec_bsearch(vec_t *vec, void *item, size_t *index) {
+  size_t lo = 0;
+  size_t hi = vec->length;
+
+  /* find the first item >= `item` */
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (vec->cmpfn(vec->items[mid], item) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  if (NULL != index) *index = lo;
+  return lo < vec->length && vec->cmpfn(vec->items[lo], item) == 0;
+}
@@ -2,27 +2,53 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "alloc.h"
+#include "defs.h"
+#include "strings.h"
+
 
-typedef struct string String_t;
 struct string {
+  allocator_t allocator;
+  memstat_t mem;
   size_t length;
   size_t capacity;
   char data[];
 };
 
 
-String_t *string_create(char *cstr, size_t initial_capacity) {
+String_t *string_create_with_allocator(char *cstr, size_t initial_capacity,
+                                       const allocator_t *allocator) {
+  if (NULL == allocator) allocator = &stdlib_allocator;
+
   size_t len = strlen(cstr);
   if (initial_capacity < len) initial_capacity = len; // Ensure minimal capacity
-  
+
   String_t *s;
-  s = malloc(sizeof(String_t) + initial_capacity + 1); // +1 for null terminator
+  size_t size = sizeof(String_t) + initial_capacity + 1; // +1 for null terminator
+  s = allocator->alloc(allocator->ctx, size);
   if (!s) return NULL;
-  
+
+  s->allocator = *allocator;
+  s->mem.inuse = size;
+  s->mem.peak = size;
   s->length = len;
   s->capacity = initial_capacity;
   memcpy(s->data, cstr, len + 1); // Copy data and null terminator
   return s;
 }
 
-void string_free(String_t *s) { free(s); }
+String_t *string_create(char *cstr, size_t initial_capacity) {
+  return string_create_with_allocator(cstr, initial_capacity, NULL);
+}
+
+void string_memstat(String_t *s, memstat_t *stat) { *stat = s->mem; }
+
+const char *string_cstr(String_t *s) { return s->data; }
+
+size_t string_length(String_t *s) { return s->length; }
+
+void string_free(String_t *s) {
+  if (!s) return;
+  allocator_t allocator = s->allocator;
+  allocator.free(allocator.ctx, s, s->mem.inuse);
+}
@@ -0,0 +1,67 @@
+/**
+ * @brief Heap-allocated strings that keep their length and capacity with the characters.
+ *
+ * @details
+ * Uses `allocator_t` and `memstat_t` from the linked list's `defs.h`, so the include path must
+ * contain `data-structures/doubly-linked-list/include`, and `alloc.c` from there must be linked.
+ * The header is included with quotes, to keep it apart from the POSIX `<strings.h>`.
+ */
+
+#ifndef SNIPPETS_STRINGS_H
+#define SNIPPETS_STRINGS_H
+
+#include "defs.h"
+
+#include <stdlib.h>
+
+/**
+ * Type of string. `String_t` is an alias for `struct string`
+ */
+typedef struct string String_t;
+
+/**
+ * @brief Create a new string holding a copy of `cstr`
+ * @param cstr: null-terminated string to copy
+ * @param initial_capacity: characters to make room for. Raised to the length of `cstr`
+ * @returns A pointer to the newly allocated string, or `NULL` on failure.
+ */
+String_t *string_create(char *cstr, size_t initial_capacity);
+
+/**
+ * @brief Create a new string with the given allocator
+ * @param cstr: null-terminated string to copy
+ * @param initial_capacity: characters to make room for. Raised to the length of `cstr`
+ * @param allocator: nullable. The struct is copied. If `NULL`, malloc/free are used
+ * @returns A pointer to the newly allocated string, or `NULL` on failure.
+ */
+String_t *string_create_with_allocator(char *cstr, size_t initial_capacity,
+                                       const allocator_t *allocator);
+
+/**
+ * @brief Get the memory used by a string, header and characters
+ * @param s: pointer to string
+ * @param stat: set to the bytes currently in use, and the peak over the lifetime of the string
+ */
+void string_memstat(String_t *s, memstat_t *stat);
+
+/**
+ * @brief Get the characters of a string
+ * @param s: pointer to string
+ * @returns A pointer to the null-terminated characters, valid until the string is freed
+ */
+const char *string_cstr(String_t *s);
+
+/**
+ * @brief Get the length of a string, without the null terminator
+ * @param s: pointer to string
+ * @returns Number of characters in `s`
+ */
+size_t string_length(String_t *s);
+
+/**
+ * @brief Free a string
+ * @param s: nullable. Pointer to string
+ */
+void string_free(String_t *s);
+
+#endif /* SNIPPETS_STRINGS_H */